@@ -0,0 +1,97 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Allocations.h"
+
+namespace bench {
+
+// keeps the compiler from dropping a result the benchmark never reads
+template <class T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  size_t n = 0;            // entity count the case was built with
+  uint64_t iterations = 0; // times the body ran in the timed batch
+  double nsPerOp = 0;      // one op is one entity, pair or vector
+  double allocsPerOp = 0;
+};
+
+class Runner {
+  std::vector<Result> m_results;
+  std::chrono::nanoseconds m_minTime;
+  std::string m_filter;
+
+public:
+  Runner(std::chrono::nanoseconds minTime, std::string filter)
+      : m_minTime(minTime), m_filter(std::move(filter)) {}
+
+  bool wants(const std::string &name) const {
+    return m_filter.empty() || name.find(m_filter) != std::string::npos;
+  }
+
+  // runs body() once to warm up, then doubles the batch until it takes at
+  // least the minimum time; each call of body() does n ops
+  template <class F> void run(const std::string &name, size_t n, F &&body) {
+    using Clock = std::chrono::steady_clock;
+    body();
+    uint64_t iterations = 1;
+    while (true) {
+      uint64_t allocations = Allocations::thisThread().count;
+      auto start = Clock::now();
+      for (uint64_t i = 0; i < iterations; i++) {
+        body();
+      }
+      auto elapsed = Clock::now() - start;
+      allocations = Allocations::thisThread().count - allocations;
+      if (elapsed >= m_minTime || iterations >= (uint64_t(1) << 30)) {
+        double ops = double(iterations) * double(n);
+        Result result{name, n, iterations,
+                      double(std::chrono::nanoseconds(elapsed).count()) / ops,
+                      double(allocations) / ops};
+        m_results.push_back(result);
+        print(result, std::cout);
+        return;
+      }
+      iterations *= 2;
+    }
+  }
+
+  static void print(const Result &result, std::ostream &out) {
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "%-32s %8zu %12.3f ns/op %10.4f allocs/op",
+                  result.name.c_str(), result.n, result.nsPerOp,
+                  result.allocsPerOp);
+    out << line << std::endl;
+  }
+
+  void writeJson(std::ostream &out) const {
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < m_results.size(); i++) {
+      const Result &r = m_results[i];
+      char line[256];
+      std::snprintf(line, sizeof(line),
+                    "    {\"name\": \"%s\", \"n\": %zu, \"iterations\": %llu, "
+                    "\"ns_per_op\": %.3f, \"allocs_per_op\": %.4f}",
+                    r.name.c_str(), r.n, (unsigned long long)r.iterations,
+                    r.nsPerOp, r.allocsPerOp);
+      out << line << (i + 1 < m_results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+  }
+};
+
+} // namespace bench
+
+#endif // BENCH_H
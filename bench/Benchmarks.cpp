@@ -0,0 +1,229 @@
+#include "Bench.h"
+
+#include "Animation.h"
+#include "EntityManager.h"
+#include "LevelGenerator.h"
+#include "Physics.h"
+#include "Vec2.h"
+
+#include <SFML/Graphics/Texture.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const char *const kTags[] = {"tile", "dec", "enemy", "player"};
+
+// fills the manager with n entities spread over the game's tags, laid out
+// on a 64 wide grid of 64x64 boxes so neighbours touch
+std::vector<std::shared_ptr<Entity>> populate(EntityManager &entities,
+                                              size_t n) {
+  std::vector<std::shared_ptr<Entity>> added;
+  added.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    auto entity = entities.addEntity(kTags[i % 4]);
+    entity->addComponent<CTransform>(
+        Vec2(float(i % 64) * 64.0f, float(i / 64) * 64.0f));
+    entity->addComponent<CBoundingBox>(Vec2(64, 64));
+    added.push_back(entity);
+  }
+  entities.update();
+  return added;
+}
+
+void benchEntityManager(bench::Runner &runner, size_t n) {
+  if (runner.wants("EntityManager::update")) {
+    EntityManager entities;
+    populate(entities, n);
+    runner.run("EntityManager::update", n, [&] { entities.update(); });
+  }
+
+  // one percent of the entities die and respawn every update, like
+  // bullets and broken tiles do in a busy frame
+  if (runner.wants("EntityManager::churn")) {
+    EntityManager entities;
+    auto live = populate(entities, n);
+    size_t churn = std::max<size_t>(1, n / 100);
+    size_t next = 0;
+    runner.run("EntityManager::churn", n, [&] {
+      for (size_t i = 0; i < churn; i++) {
+        size_t slot = (next + i) % n;
+        live[slot]->destroy();
+        live[slot] = entities.addEntity(kTags[slot % 4]);
+      }
+      next = (next + churn) % n;
+      entities.update();
+    });
+  }
+
+  // the same with every tag pooled, the dead are recycled on update
+  if (runner.wants("EntityManager::churnPooled")) {
+    EntityManager entities;
+    size_t churn = std::max<size_t>(1, n / 100);
+    for (const char *tag : kTags) {
+      entities.addPool(tag, n / 4 + 1 + churn);
+    }
+    auto live = populate(entities, n);
+    size_t next = 0;
+    runner.run("EntityManager::churnPooled", n, [&] {
+      for (size_t i = 0; i < churn; i++) {
+        size_t slot = (next + i) % n;
+        live[slot]->destroy();
+        live[slot] = entities.addEntity(kTags[slot % 4]);
+      }
+      next = (next + churn) % n;
+      entities.update();
+    });
+  }
+
+  if (runner.wants("EntityManager::addEntity")) {
+    runner.run("EntityManager::addEntity", n, [&] {
+      EntityManager entities;
+      for (size_t i = 0; i < n; i++) {
+        entities.addEntity(kTags[i % 4]);
+      }
+      entities.update();
+      bench::doNotOptimize(entities.getEntities().size());
+    });
+  }
+}
+
+void benchPhysics(bench::Runner &runner, size_t n) {
+  if (!runner.wants("Physics::GetOverlap")) {
+    return;
+  }
+  EntityManager entities;
+  auto boxes = populate(entities, n);
+  Physics physics;
+  runner.run("Physics::GetOverlap", n, [&] {
+    float total = 0;
+    for (size_t i = 0; i < n; i++) {
+      Vec2 overlap = physics.GetOverlap(boxes[i], boxes[(i + 1) % n]);
+      total += overlap.x + overlap.y;
+    }
+    bench::doNotOptimize(total);
+  });
+}
+
+void benchAnimation(bench::Runner &runner, size_t n) {
+  if (!runner.wants("Animation::update")) {
+    return;
+  }
+  // the texture is never drawn, update only touches the sprite rect
+  static const sf::Texture texture;
+  std::vector<Animation> animations(n, Animation("Bench", texture, 4, 2));
+  runner.run("Animation::update", n, [&] {
+    for (size_t i = 0; i < n; i++) {
+      animations[i].update(i & 1);
+    }
+    bench::doNotOptimize(animations.back().getSprite());
+  });
+}
+
+void benchVec2(bench::Runner &runner, size_t n) {
+  if (!runner.wants("Vec2::integrate")) {
+    return;
+  }
+  std::vector<Vec2> pos(n), vel(n, Vec2(3, -8));
+  const Vec2 gravity(0, 0.75f);
+  runner.run("Vec2::integrate", n, [&] {
+    float total = 0;
+    for (size_t i = 0; i < n; i++) {
+      vel[i] += gravity;
+      pos[i] += vel[i] * 0.5f;
+      total += length(normalize(pos[i] - vel[i]));
+    }
+    bench::doNotOptimize(total);
+  });
+}
+
+// parses and maps generated levels of n tiles, one op is one level entity
+void benchLevel(bench::Runner &runner, size_t n) {
+  if (!runner.wants("LevelData::loadFromText") &&
+      !runner.wants("CompiledLevel::open")) {
+    return;
+  }
+  LevelGeneratorConfig config;
+  config.tiles = uint32_t(n);
+  config.length = 0;
+  const LevelData level = generateLevel(config);
+  const auto directory = std::filesystem::temp_directory_path();
+  const std::string text = (directory / "megaMario_bench.txt").string();
+  const std::string compiled = (directory / "megaMario_bench.lvl").string();
+  level.writeText(text);
+  level.writeBinary(compiled);
+  const size_t entities = level.entities.size();
+
+  if (runner.wants("LevelData::loadFromText")) {
+    runner.run("LevelData::loadFromText", entities, [&] {
+      LevelData loaded;
+      loaded.loadFromText(text);
+      bench::doNotOptimize(loaded.chunks.size());
+    });
+  }
+  if (runner.wants("CompiledLevel::open")) {
+    runner.run("CompiledLevel::open", entities, [&] {
+      CompiledLevel loaded;
+      loaded.open(compiled);
+      bench::doNotOptimize(loaded.entities());
+    });
+  }
+  std::filesystem::remove(text);
+  std::filesystem::remove(compiled);
+}
+
+void usage(const char *program) {
+  std::cerr << "usage: " << program
+            << " [--json file] [--filter name] [--max n] [--min-time ms]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string jsonPath;
+  std::string filter;
+  size_t maxCount = 1000000;
+  long minTimeMs = 200;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return 1;
+    }
+    if (arg == "--json") {
+      jsonPath = argv[++i];
+    } else if (arg == "--filter") {
+      filter = argv[++i];
+    } else if (arg == "--max") {
+      maxCount = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--min-time") {
+      minTimeMs = std::strtol(argv[++i], nullptr, 10);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  bench::Runner runner(std::chrono::milliseconds(minTimeMs), filter);
+  for (size_t n = 100; n <= maxCount; n *= 10) {
+    benchEntityManager(runner, n);
+    benchPhysics(runner, n);
+    benchAnimation(runner, n);
+    benchVec2(runner, n);
+    benchLevel(runner, n);
+  }
+
+  if (!jsonPath.empty()) {
+    std::ofstream out(jsonPath);
+    if (!out) {
+      std::cerr << "could not write " << jsonPath << "\n";
+      return 1;
+    }
+    runner.writeJson(out);
+  }
+  return 0;
+}
@@ -1,21 +1,48 @@
 #ifndef ACTION_H
 #define ACTION_H
 
+#include <cstdint>
 #include <string>
 
+// every action a scene can register, the names are interned to these ids by
+// Scene::registerAction so input handling never touches strings
+enum class ActionName : uint8_t {
+  None,
+  Up,
+  Down,
+  Left,
+  Right,
+  Jump,
+  Shoot,
+  Play,
+  Quit,
+  Pause,
+  ToggleTexture,
+  ToggleCollision,
+  ToggleGrid,
+  Count
+};
+
+enum class ActionType : uint8_t { Start, End };
+
 class Action {
 public:
   Action();
 
-  Action(std::string name, std::string type);
+  Action(ActionName name, ActionType type);
+
+  [[nodiscard]] ActionName name() const;
+
+  [[nodiscard]] ActionType type() const;
 
-  [[nodiscard]] const std::string &name() const;
+  // maps an action name such as "JUMP" to its id, None if it is unknown
+  static ActionName intern(const std::string &name);
 
-  [[nodiscard]] const std::string &type() const;
+  static const char *toString(ActionName name);
 
 private:
-  std::string m_name;
-  std::string m_type;
+  ActionName m_name = ActionName::None;
+  ActionType m_type = ActionType::Start;
 };
 
 #endif // ACTION_H
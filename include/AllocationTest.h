@@ -0,0 +1,43 @@
+#ifndef ALLOCATION_TEST_H
+#define ALLOCATION_TEST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Action.h"
+
+// Plays the first level from the menu, first standing still with the grid
+// and bounding boxes drawn, then running right and shooting, and fails if
+// any of the measured frames allocated. Level streaming is reported but
+// allowed, it loads new content. Driven by GameEngine with --alloc-test.
+class AllocationTest {
+public:
+  static constexpr uint32_t kWarmUpFrames = 60;
+  static constexpr uint32_t kFrames = 300;
+  static constexpr uint32_t kShotInterval = 8;
+
+private:
+  enum class Phase { Menu, IdleWarmUp, Idle, RunningWarmUp, Running, Done };
+
+  Phase m_phase = Phase::Menu;
+  uint64_t m_phaseStart = 0; // Profiler::now() when measuring started
+  bool m_failed = false;
+  std::vector<Action> m_actions;
+
+  // compares the profiler zones of the measured frames, prints them
+  void check(const char *phase);
+
+public:
+  AllocationTest();
+
+  // the actions to send to the scene before its update on this tick
+  const std::vector<Action> &update(const std::string &sceneName,
+                                    uint32_t tick);
+
+  [[nodiscard]] bool finished() const;
+
+  [[nodiscard]] bool failed() const;
+};
+
+#endif // ALLOCATION_TEST_H
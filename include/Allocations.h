@@ -0,0 +1,19 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <cstdint>
+
+// Counts what goes through the global operator new, which Allocations.cpp
+// replaces. The counters are per thread, so a system measures its own
+// allocations and not those of the workers running next to it.
+namespace Allocations {
+struct Counts {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+// everything the calling thread allocated since it started
+Counts thisThread();
+} // namespace Allocations
+
+#endif // ALLOCATIONS_H
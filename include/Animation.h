@@ -27,10 +27,17 @@ public:
 
   bool hasEnded() const;
 
+  // shows the given frame, used when the frame comes from a shared clock
+  void setFrame(size_t frame);
+
   const std::string &getName() const;
 
   const Vec2 &getSize() const;
 
+  size_t getFrameCount() const;
+
+  size_t getSpeed() const;
+
   sf::Sprite &getSprite();
 
   void setFlipped(bool flipped);
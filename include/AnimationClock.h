@@ -0,0 +1,39 @@
+#ifndef ANIMATION_CLOCK_H
+#define ANIMATION_CLOCK_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Animation.h"
+
+// Looping animations that every entity plays in lockstep (e.g. all the
+// Question tiles) are advanced once per tick here instead of once per entity.
+// Entities only keep the index of their clip and are drawn with its sprite.
+class AnimationClock {
+  struct Clip {
+    Animation animation;
+    size_t frame = 0; // frame currently shown by the clip's sprite
+  };
+
+  std::vector<Clip> m_clips;
+  std::map<std::string, size_t> m_clipIndex; // only used while loading
+
+public:
+  AnimationClock();
+
+  // true when the animation loops over several frames and can be shared
+  static bool isShareable(const Animation &animation);
+
+  // returns the clip for this animation, registering it on first use
+  size_t registerClip(const Animation &animation);
+
+  // sets the current frame of every clip from the global tick
+  void update(size_t tick);
+
+  sf::Sprite &sprite(size_t clip);
+
+  [[nodiscard]] size_t size() const;
+};
+
+#endif // ANIMATION_CLOCK_H
@@ -0,0 +1,51 @@
+#ifndef ANIMATION_STATE_MACHINE_H
+#define ANIMATION_STATE_MACHINE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Animation.h"
+#include "Components.h"
+
+// a transition condition is a test on the CState flags:
+// (state.flags & mask) == value
+struct AnimationCondition {
+  uint32_t mask = 0;
+  uint32_t value = 0;
+};
+
+class AnimationStateMachine {
+  struct State {
+    Animation clip;
+    size_t firstTransition = 0; // index into m_transitions
+    size_t transitionCount = 0;
+  };
+
+  struct Transition {
+    size_t from = 0;
+    size_t to = 0;
+    AnimationCondition condition;
+  };
+
+  std::vector<State> m_states;
+  std::vector<Transition> m_transitions;
+
+public:
+  AnimationStateMachine();
+
+  size_t addState(const Animation &clip);
+
+  void addTransition(size_t from, size_t to, AnimationCondition condition);
+
+  // groups the transitions by source state, must be called after the last
+  // addTransition and before the first update
+  void compile();
+
+  // takes the first transition of the current state whose condition holds and
+  // swaps the clip only then, otherwise the current clip is just advanced
+  void update(CState &state, CAnimation &animation, bool flipped) const;
+
+  [[nodiscard]] const Animation &clip(size_t state) const;
+};
+
+#endif // ANIMATION_STATE_MACHINE_H
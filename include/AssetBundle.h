@@ -0,0 +1,130 @@
+#ifndef ASSET_BUNDLE_H
+#define ASSET_BUNDLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Packed asset bundle, written by the megaMario_bundler tool from assets.txt
+// and mapped by Assets::loadFromBundle. All fields are native endian and
+// every record is 4 byte aligned, pixel and font data 16 byte aligned.
+//
+//   Header
+//   TextureRecord[textureCount]     name index + RGBA8 pixels
+//   AnimationRecord[animationCount] frame tables
+//   FontRecord[fontCount]           raw font file bytes
+//   TileTypeRecord[tileTypeCount]
+//   string table                    NUL terminated names
+//   pixel / font data
+namespace AssetBundle {
+constexpr uint32_t kMagic = 0x42414d4d; // "MMAB"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kNone = UINT32_MAX; // for optional record indices
+
+struct Header {
+  uint32_t magic = kMagic;
+  uint32_t version = kVersion;
+  uint32_t textureCount = 0;
+  uint32_t animationCount = 0;
+  uint32_t fontCount = 0;
+  uint32_t tileTypeCount = 0;
+  uint32_t texturesOffset = 0;
+  uint32_t animationsOffset = 0;
+  uint32_t fontsOffset = 0;
+  uint32_t tileTypesOffset = 0;
+  uint32_t stringsOffset = 0;
+  uint32_t stringsSize = 0;
+};
+
+struct TextureRecord {
+  uint32_t name = 0; // offset into the string table
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t pixelsOffset = 0; // width * height * 4 bytes of RGBA
+};
+
+struct AnimationRecord {
+  uint32_t name = 0;
+  uint32_t texture = 0; // index of the TextureRecord
+  uint32_t frameCount = 1;
+  uint32_t speed = 0;
+};
+
+struct FontRecord {
+  uint32_t name = 0;
+  uint32_t dataOffset = 0;
+  uint32_t dataSize = 0;
+};
+
+struct TileTypeRecord {
+  uint32_t animation = 0; // index of the AnimationRecord
+  uint32_t flags = 0;     // TileProperties::Flag bits
+  uint32_t reward = kNone;
+  uint32_t bumped = kNone;
+};
+} // namespace AssetBundle
+
+class AssetBundleWriter {
+  std::vector<AssetBundle::TextureRecord> m_textures;
+  std::vector<AssetBundle::AnimationRecord> m_animations;
+  std::vector<AssetBundle::FontRecord> m_fonts;
+  std::vector<AssetBundle::TileTypeRecord> m_tileTypes;
+  std::vector<char> m_strings;
+  std::vector<char> m_data; // pixels and font files, offsets fixed on write
+
+  uint32_t addString(const std::string &s);
+
+  uint32_t addData(const void *data, size_t size);
+
+public:
+  AssetBundleWriter();
+
+  uint32_t addTexture(const std::string &name, uint32_t width, uint32_t height,
+                      const uint8_t *rgba);
+
+  uint32_t addAnimation(const std::string &name, uint32_t texture,
+                        uint32_t frameCount, uint32_t speed);
+
+  uint32_t addFont(const std::string &name, const std::vector<char> &data);
+
+  void addTileType(uint32_t animation, uint32_t flags, uint32_t reward,
+                   uint32_t bumped);
+
+  // throws AssetError when the file can not be written
+  void writeToFile(const std::string &path) const;
+};
+
+// Zero-copy view of a mapped bundle, the pointers it returns stay valid as
+// long as the reader is alive.
+class AssetBundleReader {
+  MappedFile m_file;
+  const AssetBundle::Header *m_header = nullptr;
+
+  template <class T> const T &record(uint32_t tableOffset, uint32_t i) const;
+
+public:
+  AssetBundleReader();
+
+  // maps and validates the bundle, throws AssetError if it is not usable
+  void open(const std::string &path);
+
+  [[nodiscard]] bool isOpen() const;
+
+  [[nodiscard]] const AssetBundle::Header &header() const;
+
+  [[nodiscard]] const AssetBundle::TextureRecord &texture(uint32_t i) const;
+
+  [[nodiscard]] const AssetBundle::AnimationRecord &animation(uint32_t i) const;
+
+  [[nodiscard]] const AssetBundle::FontRecord &font(uint32_t i) const;
+
+  [[nodiscard]] const AssetBundle::TileTypeRecord &tileType(uint32_t i) const;
+
+  [[nodiscard]] const char *string(uint32_t offset) const;
+
+  [[nodiscard]] const char *data(uint32_t offset) const;
+};
+
+#endif // ASSET_BUNDLE_H
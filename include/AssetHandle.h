@@ -0,0 +1,37 @@
+#ifndef ASSET_HANDLE_H
+#define ASSET_HANDLE_H
+
+#include <cstdint>
+
+// Small typed index into one of the Assets arrays. Handles are resolved from
+// names once (at scene init / level load) and then used for O(1) access.
+// The template parameter only keeps texture, animation and font handles
+// from being mixed up.
+template <class T> class AssetHandle {
+public:
+  static constexpr uint32_t kInvalid = UINT32_MAX;
+
+  uint32_t index = kInvalid;
+
+  AssetHandle() = default;
+
+  explicit AssetHandle(uint32_t i) : index(i) {}
+
+  [[nodiscard]] bool isValid() const { return index != kInvalid; }
+
+  bool operator==(const AssetHandle &rhs) const { return index == rhs.index; }
+
+  bool operator!=(const AssetHandle &rhs) const { return index != rhs.index; }
+};
+
+namespace sf {
+class Texture;
+class Font;
+} // namespace sf
+class Animation;
+
+typedef AssetHandle<sf::Texture> TextureHandle;
+typedef AssetHandle<Animation> AnimationHandle;
+typedef AssetHandle<sf::Font> FontHandle;
+
+#endif // ASSET_HANDLE_H
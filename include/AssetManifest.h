@@ -0,0 +1,53 @@
+#ifndef ASSET_MANIFEST_H
+#define ASSET_MANIFEST_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// thrown when an asset can not be loaded or a name does not exist
+class AssetError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// The parsed contents of an assets file (see README for the syntax). Kept
+// free of SFML so loading can be planned before anything is decoded.
+class AssetManifest {
+public:
+  struct TextureEntry {
+    std::string name;
+    std::string path;
+  };
+
+  struct AnimationEntry {
+    std::string name;
+    std::string texture;
+    size_t frameCount = 1;
+    size_t speed = 0;
+  };
+
+  struct FontEntry {
+    std::string name;
+    std::string path;
+  };
+
+  struct TileTypeEntry {
+    std::string animation;
+    std::string flags;
+    std::string reward; // '-' when there is none
+    std::string bumped; // '-' when there is none
+  };
+
+  std::vector<TextureEntry> textures;
+  std::vector<AnimationEntry> animations;
+  std::vector<FontEntry> fonts;
+  std::vector<TileTypeEntry> tileTypes;
+
+  AssetManifest();
+
+  // throws AssetError when the file is missing or has an unknown line type
+  void loadFromFile(const std::string &path);
+};
+
+#endif // ASSET_MANIFEST_H
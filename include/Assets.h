@@ -1,34 +1,222 @@
 #ifndef ASSETS_H
 #define ASSETS_H
 
+#include <cstdint>
+#include <deque>
+#include <future>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "Animation.h"
+#include "AssetBundle.h"
+#include "AssetHandle.h"
+#include "AssetManifest.h"
+#include "TileProperties.h"
 #include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Texture.hpp>
 
+class ThreadPool;
+
+// Catalogue of every asset named in the assets file. Loading the file only
+// registers the entries; textures and fonts become resident when a scene
+// acquires them (see AssetScope) and are evicted once nothing uses them,
+// keeping at most m_memoryBudget bytes of unused assets cached.
 class Assets {
-  std::map<std::string, sf::Texture> m_textureMap;
-  std::map<std::string, Animation> m_animationMap;
-  std::map<std::string, sf::Font> m_fontMap;
+  struct TextureSlot {
+    std::string path;                           // image file, or
+    uint32_t bundleRecord = AssetBundle::kNone; // record in m_bundle
+    size_t bytes = 0;                           // known once loaded
+    uint32_t users = 0;
+    uint64_t lastUsed = 0; // eviction order of unused textures
+    bool resident = false;
+    std::shared_future<sf::Image> decoding; // started by prefetch
+  };
+
+  struct AnimationSlot {
+    std::string name;
+    TextureHandle texture;
+    size_t frameCount = 1;
+    size_t speed = 0;
+    uint32_t users = 0;
+    bool built = false; // the Animation needs its texture size
+  };
+
+  struct FontSlot {
+    std::string path;
+    uint32_t bundleRecord = AssetBundle::kNone;
+    size_t bytes = 0;
+    uint32_t users = 0;
+    uint64_t lastUsed = 0;
+    bool resident = false;
+    std::shared_future<std::vector<char>> reading; // started by prefetch
+  };
+
+  // deques so references to assets stay valid while more are added,
+  // sprites keep pointers to their textures and texts to their fonts
+  std::deque<sf::Texture> m_textures;
+  std::deque<Animation> m_animations;
+  std::deque<sf::Font> m_fonts;
+  std::deque<std::vector<char>> m_fontData; // sf::Font reads from it lazily
+  std::vector<TextureSlot> m_textureSlots;
+  std::vector<AnimationSlot> m_animationSlots;
+  std::vector<FontSlot> m_fontSlots;
+  std::vector<TileProperties> m_tileProperties; // indexed like m_animations
+  AssetBundleReader m_bundle; // pixels and fonts are read from the mapping
+
+  // name -> handle, only used when resolving handles
+  std::map<std::string, TextureHandle> m_textureMap;
+  std::map<std::string, AnimationHandle> m_animationMap;
+  std::map<std::string, FontHandle> m_fontMap;
+
+  // textures of the last prefetch, their images are held outside the budget
+  std::vector<TextureHandle> m_prefetched;
+
+  ThreadPool *m_threadPool = nullptr; // decodes in parallel when set
+  size_t m_memoryBudget = 0;          // bytes of unused assets kept cached
+  size_t m_residentBytes = 0;
+  size_t m_unusedBytes = 0;
+  uint64_t m_useCounter = 0;
+
+  void loadTextures(const std::vector<TextureHandle> &textures);
+
+  void loadFont(FontHandle handle);
+
+  void buildAnimation(AnimationHandle handle);
+
+  void reloadTexture(TextureHandle handle);
+
+  void reloadFont(FontHandle handle);
+
+  // moves the users of an animation to the texture it now uses
+  void retarget(AnimationHandle handle, TextureHandle texture);
+
+  // rebuilds the built animations of these textures and adds them to rebuilt
+  void rebuildAnimations(const std::vector<TextureHandle> &textures,
+                         std::vector<AnimationHandle> &rebuilt);
+
+  void evictUnused();
 
 public:
   Assets();
 
+  void setThreadPool(ThreadPool *threadPool);
+
+  void setMemoryBudget(size_t bytes);
+
+  // true for paths loadFromFile treats as a packed bundle
+  static bool isBundle(const std::string &path);
+
+  // registers a text manifest, or a packed bundle when the path ends in
+  // .bundle, nothing is loaded until it is acquired
   void loadFromFile(const std::string &path);
 
+  // maps a bundle built by megaMario_bundler, resident pixels are uploaded
+  // straight from the mapping and fonts read from it, nothing is decoded
+  void loadFromBundle(const std::string &path);
+
+  void load(const AssetManifest &manifest);
+
   void addTexture(const std::string &name, const std::string &path);
 
-  void addAnimation(const std::string &name, const Animation &animation);
+  void addAnimation(const std::string &name, const std::string &texture,
+                    size_t frameCount, size_t speed);
 
   void addFont(const std::string &name, const std::string &path);
 
-  const sf::Texture &getTexture(const std::string &name) const;
+  void setTileProperties(AnimationHandle animation,
+                         const TileProperties &properties);
+
+  // starts decoding the textures of these animations on the thread pool
+  // without waiting, a later acquire only has to upload them; images a
+  // previous prefetch decoded for other textures are dropped
+  void prefetch(const std::vector<AnimationHandle> &animations);
+
+  // reads the font file on the thread pool, acquire only parses it
+  void prefetch(FontHandle font);
+
+  // true when acquiring the font does not have to wait for the disk
+  [[nodiscard]] bool isReady(FontHandle font) const;
+
+  // reference counted residency, textures missing for a batch of animations
+  // are decoded in parallel
+  void acquire(const std::vector<AnimationHandle> &animations);
+
+  void acquire(FontHandle font);
+
+  void release(AnimationHandle animation);
 
+  void release(FontHandle font);
+
+  // hot reload: applies a changed manifest or a changed image or font file
+  // to the registered and resident assets in place, so everything pointing
+  // at them stays valid; returns the animations that were rebuilt, which
+  // users holding copies have to pick up again
+  std::vector<AnimationHandle> reloadManifest(const std::string &path);
+
+  std::vector<AnimationHandle> reloadFile(const std::string &path);
+
+  // image and font files named by the manifest, empty for a bundle
+  [[nodiscard]] std::vector<std::string> sourceFiles() const;
+
+  [[nodiscard]] bool isResident(AnimationHandle animation) const;
+
+  [[nodiscard]] size_t residentBytes() const;
+
+  // name lookups, throw AssetError when the name is unknown
+  TextureHandle getTextureHandle(const std::string &name) const;
+
+  AnimationHandle getAnimationHandle(const std::string &name) const;
+
+  FontHandle getFontHandle(const std::string &name) const;
+
+  // O(1) access by handle, the asset has to be acquired
+  const sf::Texture &getTexture(TextureHandle handle) const;
+
+  const Animation &getAnimation(AnimationHandle handle) const;
+
+  const sf::Font &getFont(FontHandle handle) const;
+
+  // animations without a 'TileType' line are plain solid tiles, the table is
+  // always available
+  const TileProperties &getTileProperties(AnimationHandle handle) const;
+
+  // convenience for cold paths, a name lookup followed by the handle access
   const Animation &getAnimation(const std::string &name) const;
 
   const sf::Font &getFont(const std::string &name) const;
 };
 
+// The assets one scene depends on. Everything required through a scope stays
+// resident until the scope is released or destroyed; each scope holds at
+// most one reference per asset.
+class AssetScope {
+  Assets *m_assets = nullptr;
+  std::vector<AnimationHandle> m_animations;
+  std::vector<FontHandle> m_fonts;
+
+  bool holds(AnimationHandle animation) const;
+
+public:
+  AssetScope();
+
+  explicit AssetScope(Assets *assets);
+
+  ~AssetScope();
+
+  AssetScope(const AssetScope &) = delete;
+
+  AssetScope &operator=(const AssetScope &) = delete;
+
+  // also requires the reward and bumped animations of their tile types
+  void require(const std::vector<AnimationHandle> &animations);
+
+  AnimationHandle require(const std::string &animation);
+
+  FontHandle requireFont(const std::string &font);
+
+  void releaseAll();
+};
+
 #endif // ASSETS_H
@@ -1,10 +1,12 @@
 #ifndef COMPONENTS_H
 #define COMPONENTS_H
 
+#include <cstdint>
 #include <utility>
 
 #include "Animation.h"
 #include "Assets.h"
+#include "TileProperties.h"
 
 class Component {
 public:
@@ -66,6 +68,7 @@ class CAnimation : public Component {
 public:
   Animation animation;
   bool repeat = false;
+  int sharedClip = -1; // index into the scene's AnimationClock, -1 if none
 
   CAnimation() = default;
 
@@ -83,11 +86,40 @@ public:
 
 class CState : public Component {
 public:
-  std::string state = "jumping";
+  enum Flag : uint32_t {
+    OnGround = 1 << 0,
+    Moving = 1 << 1,
+    FacingLeft = 1 << 2,
+  };
+
+  uint32_t flags = 0;
+  size_t animationState = 0; // current state in the AnimationStateMachine
 
   CState() = default;
 
-  explicit CState(std::string s) : state(std::move(s)) {}
+  explicit CState(size_t animState) : animationState(animState) {}
+
+  [[nodiscard]] bool test(uint32_t flag) const { return (flags & flag) != 0; }
+
+  void set(uint32_t flag, bool on) {
+    flags = on ? flags | flag : flags & ~flag;
+  }
+};
+
+class CTileProperties : public Component {
+public:
+  uint32_t flags = 0;
+  AnimationHandle reward;
+  AnimationHandle bumped;
+  uint32_t record = 0; // index of the tile in its level, see LevelStreamer
+
+  CTileProperties() = default;
+
+  explicit CTileProperties(const TileProperties &p, uint32_t levelRecord = 0)
+      : flags(p.flags), reward(p.reward), bumped(p.bumped),
+        record(levelRecord) {}
+
+  [[nodiscard]] bool test(uint32_t flag) const { return (flags & flag) != 0; }
 };
 
 #endif // COMPONENTS_H
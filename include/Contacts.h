@@ -0,0 +1,57 @@
+#ifndef CONTACTS_H
+#define CONTACTS_H
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include "Entity.h"
+#include "Vec2.h"
+
+// an entity's bounding box packed for collision detection, which then only
+// reads these and never the entities
+struct CollisionBox {
+  const std::shared_ptr<Entity> *entity; // into an EntityManager vector
+  Vec2 pos;
+  Vec2 halfSize;
+  uint32_t flags = 0; // TileProperties::Flag bits, 0 for anything else
+};
+
+// Two boxes touching on a tick. Collision detection emits them, the
+// gameplay systems after it consume them, so the detection itself does not
+// write anything and can be split over threads.
+struct Contact {
+  enum Kind : uint8_t {
+    Player, // the player overlaps a tile
+    Bullet, // a bullet overlaps a tile
+    Head,   // the player hit a tile from below, emitted by the resolution
+  };
+
+  Kind kind = Player;
+  uint32_t other = 0; // index of the player's or bullet's box
+  uint32_t tile = 0;  // index of the tile's box
+  Vec2 normal;        // the axis that pushes the other box out of the tile
+  float depth = 0;    // how far along the normal
+  uint32_t flags = 0; // TileProperties::Flag bits of the tile
+
+  // the contact of an overlap as returned by Physics::BoxOverlap, resolved
+  // along the axis that overlaps least
+  static Contact fromOverlap(Kind kind, uint32_t other, uint32_t tile,
+                             const Vec2 &overlap, uint32_t flags) {
+    Contact contact;
+    contact.kind = kind;
+    contact.other = other;
+    contact.tile = tile;
+    contact.flags = flags;
+    if (std::abs(overlap.x) < std::abs(overlap.y)) {
+      contact.normal = Vec2(overlap.x < 0 ? -1.0f : 1.0f, 0);
+      contact.depth = std::abs(overlap.x);
+    } else {
+      contact.normal = Vec2(0, overlap.y < 0 ? -1.0f : 1.0f);
+      contact.depth = std::abs(overlap.y);
+    }
+    return contact;
+  }
+};
+
+#endif // CONTACTS_H
@@ -9,14 +9,15 @@
 class EntityManager;
 
 typedef std::tuple<CTransform, CLifespan, CInput, CBoundingBox, CAnimation,
-                   CGravity, CState>
+                   CGravity, CState, CTileProperties>
     ComponentTuple;
 
 class Entity {
   friend class EntityManager;
 
   bool m_active = true;
-  const size_t m_id = 0;
+  bool m_pooled = false; // goes back to its EntityManager pool when dead
+  size_t m_id = 0;
   const std::string m_tag = "default";
   ComponentTuple m_components;
 
@@ -24,6 +25,9 @@ class Entity {
   // outside the EntityManager which had friend access
   Entity(size_t id, std::string tag);
 
+  // brings a pooled entity back to life with a new id and no components
+  void recycle(size_t id);
+
 public:
   void destroy();
 
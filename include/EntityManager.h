@@ -10,10 +10,14 @@
 typedef std::vector<std::shared_ptr<Entity>> EntityVec;
 typedef std::map<std::string, EntityVec> EntityMap;
 
+// dead entities of one tag waiting to be handed out again
+typedef std::map<std::string, EntityVec> EntityPoolMap;
+
 class EntityManager {
   EntityVec m_entities;       // all entities
   EntityVec m_entitiesToAdd;  // entities to add next update
   EntityMap m_entityMap;      //  map from entity tag to vectors
+  EntityPoolMap m_pools;      // free entities of the pooled tags
   size_t m_totalEntities = 0; // total entities created
 
   // helper function to avoid repeated code
@@ -24,12 +28,22 @@ public:
 
   void update();
 
+  // a pooled tag hands out one of its free entities, with all components
+  // removed, or nullptr when all of them are alive
   std::shared_ptr<Entity> addEntity(const std::string &tag);
 
+  // pre-allocates capacity entities for the tag, which from then on are
+  // recycled instead of freed; the tag never has more alive at once.
+  // A destroyed pooled entity must not be held on to past the next update.
+  void addPool(const std::string &tag, size_t capacity);
+
   EntityVec &getEntities();
 
   EntityVec &getEntities(const std::string &tag);
 
+  // added since the last update, they join the others on the next one
+  EntityVec &getPendingEntities();
+
   const EntityMap &getEntityMap();
 };
 
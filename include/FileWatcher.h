@@ -0,0 +1,35 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reports files that were written or replaced, using inotify. The parent
+// directory is watched so files that editors save by renaming a temporary
+// file over them are seen as well. Does nothing where inotify is missing.
+class FileWatcher {
+  int m_fd = -1;
+  std::map<std::string, int> m_directories; // directory -> watch descriptor
+  // (watch descriptor, file name) -> path as passed to watch
+  std::map<std::pair<int, std::string>, std::string> m_files;
+
+public:
+  FileWatcher();
+
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher &) = delete;
+
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  // returns false if the file can not be watched
+  bool watch(const std::string &path);
+
+  // the watched files changed since the last poll, each reported once and
+  // spelled as they were passed to watch, never blocks
+  std::vector<std::string> poll();
+};
+
+#endif // FILE_WATCHER_H
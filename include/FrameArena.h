@@ -0,0 +1,85 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that only lives for one frame, owned by
+// GameEngine and reset at the top of every run() iteration. Allocating is a
+// pointer bump and nothing is ever freed on its own. A frame that needed more
+// than the first block leaves one block big enough for all of it behind, so
+// after a few frames the arena stops touching the heap.
+//
+// Not thread safe: a parallel system hands each of its jobs one of the
+// sub-arenas, which are reset together with the arena.
+class FrameArena {
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size = 0;
+  };
+
+  std::vector<Block> m_blocks;
+  size_t m_current = 0; // block being bumped
+  size_t m_offset = 0;  // into the current block
+  size_t m_used = 0;    // bytes handed out this frame, alignment included
+  size_t m_peak = 0;
+  size_t m_blockSize;
+  std::vector<std::unique_ptr<FrameArena>> m_subArenas;
+
+public:
+  explicit FrameArena(size_t blockSize = size_t(1) << 20);
+
+  FrameArena(const FrameArena &) = delete;
+
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  void *allocate(size_t size, size_t alignment);
+
+  // forgets everything allocated this frame, in this arena and its subs
+  void reset();
+
+  // the i-th sub-arena, created on first use; only call from the thread
+  // that owns this arena, before handing them out
+  FrameArena &sub(size_t index);
+
+  [[nodiscard]] size_t used() const;
+
+  // most bytes used in one frame so far
+  [[nodiscard]] size_t peak() const;
+};
+
+// STL allocator over a FrameArena, deallocate does nothing
+template <class T> class FrameAllocator {
+  template <class U> friend class FrameAllocator;
+
+  FrameArena *m_arena;
+
+public:
+  typedef T value_type;
+
+  explicit FrameAllocator(FrameArena &arena) noexcept : m_arena(&arena) {}
+
+  template <class U>
+  FrameAllocator(const FrameAllocator<U> &other) noexcept
+      : m_arena(other.m_arena) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *, size_t) noexcept {}
+
+  template <class U> bool operator==(const FrameAllocator<U> &other) const {
+    return m_arena == other.m_arena;
+  }
+
+  template <class U> bool operator!=(const FrameAllocator<U> &other) const {
+    return m_arena != other.m_arena;
+  }
+};
+
+// a vector that must not outlive the frame it was made in
+template <class T> using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif // FRAME_ARENA_H
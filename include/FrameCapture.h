@@ -0,0 +1,95 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SFML/Graphics/Image.hpp"
+#include "SFML/Graphics/RenderWindow.hpp"
+#include "SFML/Graphics/Texture.hpp"
+
+// Screenshots and continuous captures without stalling the frame. A frame
+// is copied into one of a ring of staging textures on the GPU, and only
+// read back kStagingFrames - 1 frames later, when the copy is long done;
+// the PNG encoding and the write run on a writer thread of its own, so the
+// thread pool the frame waits on never queues behind them. Screenshots are
+// named after the time they were taken, continuous captures go into a
+// directory per run, named after the frame.
+class FrameCapture {
+public:
+  static constexpr size_t kStagingFrames = 3;
+  static constexpr size_t kMaxPendingWrites = 8; // more and frames are dropped
+
+private:
+  struct Staging {
+    sf::Texture texture;
+    bool used = false;
+    size_t frame = 0; // when it was copied
+    std::string path;
+  };
+
+  struct Write {
+    sf::Image image;
+    std::string path;
+    bool saved = false;
+  };
+
+  std::array<Staging, kStagingFrames> m_staging;
+
+  // the writer thread's queue, bounded by kMaxPendingWrites, and the writes
+  // it finished for the main thread to report
+  std::deque<Write> m_writes;
+  std::vector<Write> m_finished;
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  std::condition_variable m_drained;
+  bool m_stopping = false;
+  std::thread m_writer; // last, started once the rest is set up
+
+  size_t m_frame = 0;
+  bool m_screenshot = false;
+  size_t m_interval = 0; // continuous capture of every n-th frame, 0 is off
+  std::string m_captureDirectory;
+  size_t m_captured = 0;
+  size_t m_dropped = 0;
+
+  // false if the frame had to be dropped
+  bool stage(const sf::RenderWindow &window, std::string path);
+
+  // reads back what was staged long enough ago and queues it for the writer
+  void readBack(bool all);
+
+  // reports the finished writes, or waits for all of them first
+  void reap(bool wait);
+
+  void writerLoop();
+
+public:
+  FrameCapture();
+
+  // finishes the staged frames, waits for the writes and stops the writer
+  ~FrameCapture();
+
+  FrameCapture(const FrameCapture &) = delete;
+
+  FrameCapture &operator=(const FrameCapture &) = delete;
+
+  // the next captured frame is saved as a screenshot
+  void screenshot();
+
+  // captures every n-th frame into a new directory, 0 stops
+  void setContinuous(size_t interval);
+
+  [[nodiscard]] size_t continuousInterval() const;
+
+  // called once per frame, after drawing and before display()
+  void capture(const sf::RenderWindow &window);
+};
+
+#endif // FRAME_CAPTURE_H
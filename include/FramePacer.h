@@ -0,0 +1,93 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Ends every frame on a fixed deadline, in place of SFML's
+// setFramerateLimit which only sleeps and wakes up a millisecond or more
+// late. It sleeps until shortly before the deadline and spins the rest, the
+// spin margin following how late the sleeps have been waking up.
+//
+// When the frames keep missing the deadline the target drops to the next
+// whole fraction of the maximum rate (60, 30, 20, 15 Hz), so the frames are
+// evenly slow instead of alternating, and it goes back up once they fit
+// again. The simulation steps a fixed time per update, so the engine runs
+// ticksPerFrame() updates per presented frame to keep the game's speed.
+// With vsync the driver waits in display() and the pacer only measures.
+// The sleep is cut into slices with the idle task run between them, which
+// is how the engine picks up input while waiting.
+class FramePacer {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr size_t kHistoryFrames = 600; // the rolling window
+  static constexpr double kBucketMs = 0.25;
+  static constexpr size_t kBuckets = 200; // the last one is 50 ms and up
+
+  // of the frame times in the window, frame start to frame start
+  struct Stats {
+    size_t frames = 0;
+    double averageMs = 0;
+    double p50Ms = 0;
+    double p99Ms = 0; // the 1% low
+    double maxMs = 0;
+    size_t missed = 0;   // frames that ended past their deadline
+    double targetHz = 0; // 0 without a limit
+  };
+
+private:
+  double m_maxHz = 0;
+  bool m_vsync = false;
+  size_t m_divisor = 1; // the target is m_maxHz / m_divisor
+  Clock::time_point m_frameStart = Clock::now();
+  Clock::time_point m_deadline = m_frameStart;
+  Clock::duration m_spinMargin = std::chrono::milliseconds(1);
+  std::function<void()> m_idleTask;
+
+  // the window as a ring of frame times and a histogram of the same
+  std::array<float, kHistoryFrames> m_frameMs{};
+  std::array<bool, kHistoryFrames> m_missed{};
+  std::array<uint32_t, kBuckets> m_buckets{};
+  size_t m_next = 0;
+  size_t m_count = 0;
+  double m_totalMs = 0;
+  size_t m_totalMissed = 0;
+
+  // the frames since the target was last adapted
+  size_t m_adaptFrames = 0;
+  size_t m_adaptMissed = 0;
+  Clock::duration m_adaptWorstWork{};
+
+  [[nodiscard]] Clock::duration period() const;
+
+  void sleepUntil(Clock::time_point deadline);
+
+  void record(double frameMs, bool missed);
+
+  void adapt(Clock::duration work, bool missed);
+
+public:
+  FramePacer();
+
+  // frames per second at most, 0 runs as fast as it can
+  void setTarget(double hz);
+
+  void setVSync(bool vsync);
+
+  // run about every millisecond while sleeping, not while spinning
+  void setIdleTask(std::function<void()> task);
+
+  // called once per frame after it was presented, waits for its deadline
+  void wait();
+
+  // updates to run for the next frame, the maximum rate over the target
+  [[nodiscard]] size_t ticksPerFrame() const;
+
+  [[nodiscard]] Stats stats() const;
+};
+
+#endif // FRAME_PACER_H
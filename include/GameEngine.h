@@ -1,38 +1,120 @@
 #ifndef GAME_ENGINE_H
 #define GAME_ENGINE_H
 
-#include <map>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "AllocationTest.h"
 #include "Assets.h"
+#include "FileWatcher.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "InputQueue.h"
+#include "ProfilerOverlay.h"
+#include "Replay.h"
 #include "SFML/Graphics/RenderWindow.hpp"
 #include "Scene.h"
+#include "ThreadPool.h"
+
+// command line options, see main.cpp
+struct GameOptions {
+  std::string record;    // writes the session's input and checksums here
+  std::string replay;    // plays this recording back instead of the keyboard
+  bool headless = false; // hidden window, nothing drawn, no frame limit
+  bool vsync = false;    // the driver paces the frames instead of FramePacer
+  size_t captureInterval = 0; // captures every n-th frame from the start
+  size_t assetMemoryBudget = 0; // bytes of unused assets kept cached
+  bool allocationTest = false; // see AllocationTest
+};
 
-typedef std::map<std::string, std::shared_ptr<Scene>> SceneMap;
+struct SceneEntry {
+  std::string name;
+  std::shared_ptr<Scene> scene;
+};
 
 class GameEngine {
 protected:
   sf::RenderWindow m_window;
+  ThreadPool m_threadPool; // declared before the users so it outlives them
   Assets m_assets;
-  std::string m_currentScene;
-  SceneMap m_sceneMap;
+  std::string m_assetsPath;
+  FileWatcher m_fileWatcher; // hot reload of the manifest, images and levels
+  FramePacer m_framePacer; // waits out the end of every frame
+  InputQueue m_inputQueue; // filled while the pacer waits
+  ProfilerOverlay m_profilerOverlay{&m_assets, &m_framePacer, &m_inputQueue};
+  FrameArena m_frameArena; // reset at the top of every frame
+  FrameCapture m_frameCapture;
+  std::vector<SceneEntry> m_sceneStack; // the top one is updated and drawn
+  std::vector<SceneEntry> m_sceneCache; // finished scenes, oldest first
+  std::vector<std::function<void()>> m_sceneChanges; // applied after a frame
   size_t m_simulationSpeed = 1;
   bool m_running = true;
 
-  void init(const std::string &path);
+  // record and replay: ticks count the updates of the current scene and
+  // restart whenever it changes, which bumps the scene serial
+  ReplayRecorder m_recorder;
+  ReplayPlayer m_replay;
+  bool m_replaying = false; // until the recording runs out
+  bool m_replayDiverged = false;
+  bool m_deterministic = false;
+  bool m_headless = false;
+  bool m_rendering = false; // the current update is the one that is drawn
+  uint32_t m_sceneSerial = 0;
+  uint32_t m_sceneTick = 0;
+  std::unique_ptr<AllocationTest> m_allocationTest;
+
+  void init(const std::string &path, const GameOptions &options);
 
   void update();
 
+  // latches the queued input, right before the tick
   void sUserInput();
 
-  std::shared_ptr<Scene> currentScene();
+  void sHotReload();
+
+  // sends the action to the scene and records it
+  void sendAction(Scene &scene, const Action &action);
+
+  // plays back this tick's actions before the update and records or checks
+  // the checksum after it
+  void sReplay(Scene &scene, bool afterUpdate);
+
+  void sceneChanged();
+
+  const std::shared_ptr<Scene> &currentScene() const;
+
+  void applySceneChanges();
+
+  // caches a finished scene that can be reused, tears it down otherwise
+  void retire(SceneEntry entry);
+
+  void tearDown(SceneEntry entry);
 
 public:
   float m_frameLimit = 60.0f;
-  GameEngine(const std::string &path);
+  size_t m_sceneCacheSize = 2;   // finished scenes kept for reuse
+  size_t m_captureInterval = 10; // frames between captures toggled with F5
+  explicit GameEngine(const std::string &path, const GameOptions &options = {});
+
+  // scene changes take effect after the current frame, so a scene can
+  // replace or pop itself from its own update
+  void pushScene(const std::string &name, std::shared_ptr<Scene> scene);
+
+  void popScene();
+
+  void replaceScene(const std::string &name, std::shared_ptr<Scene> scene);
 
-  void changeScene(const std::string &sceneName, std::shared_ptr<Scene> scene,
-                   bool endCurrentScene = false);
+  // a finished scene kept under this name, reset() and ready to be pushed
+  // again, or nullptr
+  std::shared_ptr<Scene> takeCachedScene(const std::string &name);
+
+  [[nodiscard]] bool hasCachedScene(const std::string &name) const;
+
+  // tears down the finished scene kept under this name, if there is one
+  void dropCachedScene(const std::string &name);
 
   void quit();
 
@@ -42,7 +124,34 @@ public:
 
   const Assets &assets() const;
 
+  Assets &assets();
+
+  ThreadPool &threadPool();
+
+  // scratch memory that is valid until the end of the current frame
+  FrameArena &frameArena();
+
+  // registers the manifest Scene_Loading parsed, or maps the bundle, and
+  // watches the files for hot reload
+  void loadAssets(const std::string &path, const AssetManifest &manifest);
+
+  // changes to the file are passed to the current scene's onFileChanged
+  void watchFile(const std::string &path);
+
   bool isRunning();
+
+  // nothing is drawn or presented, scenes skip their sRender
+  [[nodiscard]] bool isHeadless() const;
+
+  // the scene draws in this update; not headless, and not on the extra
+  // ticks of a frame the pacer slowed down
+  [[nodiscard]] bool isRendering() const;
+
+  // recording or replaying, level streaming must not depend on timing
+  [[nodiscard]] bool isDeterministic() const;
+
+  // a replay diverged or the allocation test failed
+  [[nodiscard]] bool failed() const;
 };
 
 #endif // GAME_ENGINE_H
@@ -0,0 +1,67 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "SFML/Graphics/RenderWindow.hpp"
+#include "SFML/Window/Event.hpp"
+
+// Window events stamped with the time they were picked up. The engine pumps
+// the window while FramePacer waits, so an event is seen within a
+// millisecond of arriving rather than at the start of the next frame, and
+// latches the queue right before the simulation tick. The time from the
+// oldest input a tick used to the frame showing it is kept as the
+// input-to-photon latency, as far as the game can see it: until display()
+// returned.
+class InputQueue {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr size_t kLatencySamples = 120;
+
+  struct TimedEvent {
+    sf::Event event;
+    Clock::time_point time;
+  };
+
+  // over the last kLatencySamples frames that applied input
+  struct LatencyStats {
+    size_t samples = 0;
+    double averageMs = 0;
+    double maxMs = 0;
+    double lastMs = 0;
+  };
+
+private:
+  std::vector<TimedEvent> m_queued;
+  std::vector<TimedEvent> m_latched; // swapped in by latch(), capacity kept
+  bool m_applied = false;
+  Clock::time_point m_oldestApplied;
+
+  std::array<float, kLatencySamples> m_latencyMs{};
+  size_t m_next = 0;
+  size_t m_count = 0;
+
+public:
+  InputQueue();
+
+  // moves everything the window has into the queue
+  void pump(sf::RenderWindow &window);
+
+  // the events queued since the last latch, oldest first; valid until the
+  // next latch
+  const std::vector<TimedEvent> &latch();
+
+  // the event changed the simulation, its time counts towards the latency
+  void applied(const TimedEvent &event);
+
+  // the frame with the applied input is on screen
+  void presented();
+
+  [[nodiscard]] LatencyStats latency() const;
+};
+
+#endif // INPUT_QUEUE_H
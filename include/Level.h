@@ -0,0 +1,128 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// thrown when a level file can not be read or is malformed
+class LevelError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+struct PlayerConfig {
+  float X = 0, Y = 0, CX = 0, CY = 0, SPEED = 0, MAX_SPEED = 0, JUMP = 0,
+        GRAVITY = 0;
+  std::string WEAPON;
+};
+
+// Compiled level layout, written by megaMario_levelc and mapped by
+// CompiledLevel. Native endian, every section 4 byte aligned.
+//
+//   Header
+//   uint32_t assetNames[assetCount]  offsets into the string table
+//   ChunkRecord[chunkCount]
+//   EntityRecord[entityCount]        grouped by chunk
+//   string table                     NUL terminated animation names
+namespace LevelFormat {
+constexpr uint32_t kMagic = 0x564c4d4d; // "MMLV"
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kChunkColumns = 16; // grid columns per streamed chunk
+
+enum EntityType : uint8_t { Tile = 0, Dec = 1 };
+
+struct EntityRecord {
+  uint8_t type = Tile;
+  uint8_t padding = 0;
+  uint16_t asset = 0; // index into the asset name table
+  float gridX = 0;
+  float gridY = 0;
+};
+
+// the entities of grid columns [i * chunkColumns, (i + 1) * chunkColumns)
+struct ChunkRecord {
+  uint32_t firstEntity = 0;
+  uint32_t entityCount = 0;
+};
+
+struct Header {
+  uint32_t magic = kMagic;
+  uint32_t version = kVersion;
+  uint32_t assetCount = 0;
+  uint32_t entityCount = 0;
+  uint32_t assetsOffset = 0;
+  uint32_t entitiesOffset = 0;
+  uint32_t chunkColumns = kChunkColumns;
+  uint32_t chunkCount = 0;
+  uint32_t chunksOffset = 0;
+  uint32_t stringsOffset = 0;
+  uint32_t stringsSize = 0;
+  float playerX = 0, playerY = 0, playerCX = 0, playerCY = 0;
+  float playerSpeed = 0, playerJump = 0, playerMaxSpeed = 0,
+        playerGravity = 0;
+  uint32_t playerWeapon = 0; // index into the asset name table
+};
+} // namespace LevelFormat
+
+// A level held in memory with interned animation names, parsed from the
+// text format (see README) or built by a generator.
+class LevelData {
+public:
+  PlayerConfig player;
+  std::vector<std::string> assets;
+  std::vector<LevelFormat::EntityRecord> entities;
+  std::vector<LevelFormat::ChunkRecord> chunks;
+
+  LevelData();
+
+  // returns the index of the name in the asset table, adding it once
+  uint16_t internAsset(const std::string &name);
+
+  // groups the entities by chunk, keeping their order inside a chunk, and
+  // rebuilds the chunk table; needed after entities were added by hand
+  void buildChunks();
+
+  // parses the text level and builds its chunks
+  void loadFromText(const std::string &path);
+
+  // writes the level back in the text format, entities in table order
+  void writeText(const std::string &path) const;
+
+  void writeBinary(const std::string &path) const;
+};
+
+// Zero-copy view of a compiled level file.
+class CompiledLevel {
+  MappedFile m_file;
+  const LevelFormat::Header *m_header = nullptr;
+
+public:
+  CompiledLevel();
+
+  // maps and validates the file, throws LevelError if it is not usable
+  void open(const std::string &path);
+
+  [[nodiscard]] PlayerConfig player() const;
+
+  [[nodiscard]] uint32_t assetCount() const;
+
+  [[nodiscard]] const char *assetName(uint32_t i) const;
+
+  [[nodiscard]] uint32_t entityCount() const;
+
+  [[nodiscard]] const LevelFormat::EntityRecord *entities() const;
+
+  [[nodiscard]] uint32_t chunkCount() const;
+
+  [[nodiscard]] const LevelFormat::ChunkRecord *chunks() const;
+};
+
+// the compiled file that belongs to a text level ("level1.txt" ->
+// "level1.lvl"), empty when there is none or it is older than the text
+std::string compiledLevelPath(const std::string &textPath);
+
+#endif // LEVEL_H
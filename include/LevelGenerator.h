@@ -0,0 +1,23 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include <cstdint>
+
+#include "Level.h"
+
+struct LevelGeneratorConfig {
+  uint32_t seed = 1;
+  uint32_t length = 200;     // grid columns, a minimum when tiles is set
+  uint32_t tiles = 0;        // keeps adding columns until this many tiles
+  float density = 0.5f;      // chance scale of platforms above the ground
+  float breakable = 0.3f;    // share of platform tiles that are bricks
+  float decorations = 0.2f;  // chance of a decoration per column
+};
+
+// Builds a synthetic level out of the animations of level1: ground with
+// the odd one tile gap, brick, block and question block platforms at the
+// heights the player can jump between, clouds and bushes, and a flag pole
+// at the end. The same config always gives the same level.
+LevelData generateLevel(const LevelGeneratorConfig &config);
+
+#endif // LEVEL_GENERATOR_H
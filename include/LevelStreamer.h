@@ -0,0 +1,133 @@
+#ifndef LEVEL_STREAMER_H
+#define LEVEL_STREAMER_H
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetHandle.h"
+#include "Entity.h"
+#include "Level.h"
+#include "ThreadPool.h"
+#include "Vec2.h"
+
+// one level entity of a prepared chunk, already placed in pixels
+struct ChunkEntity {
+  LevelFormat::EntityType type = LevelFormat::Tile;
+  AnimationHandle animation;
+  uint32_t record = 0; // index of the entity in the level, see replaceTile
+  Vec2 pos;
+};
+
+// Keeps only the column chunks of a level around the camera alive.
+// Chunks are read and placed on the thread pool, spawned through the
+// spawner on the main thread and destroyed again once they are far enough
+// outside the view. Tiles that were broken or bumped stay that way when their
+// chunk comes back.
+class LevelStreamer {
+public:
+  typedef std::function<std::shared_ptr<Entity>(const ChunkEntity &)> Spawner;
+
+private:
+  struct PreparedChunk {
+    size_t index = 0;
+    std::vector<ChunkEntity> entities;
+  };
+
+  enum class ChunkState { Unloaded, Pending, Resident };
+
+  struct Chunk {
+    ChunkState state = ChunkState::Unloaded;
+    std::future<PreparedChunk> pending;
+    std::vector<std::shared_ptr<Entity>> entities;
+  };
+
+  // chunks loaded before they come into view, and kept after they left it
+  static constexpr size_t kPrefetchChunks = 1;
+  static constexpr size_t kKeepChunks = 2;
+
+  CompiledLevel m_compiled;
+  LevelData m_parsed;
+  PlayerConfig m_player;
+  std::vector<std::string> m_assetNames;
+  const LevelFormat::EntityRecord *m_records = nullptr;
+  size_t m_recordCount = 0;
+  const LevelFormat::ChunkRecord *m_chunkTable = nullptr;
+  std::vector<Chunk> m_chunks;
+
+  // set by setLayout, read by the workers
+  std::vector<AnimationHandle> m_animations;
+  std::vector<Vec2> m_animationSizes;
+  Vec2 m_gridSize;
+  float m_windowHeight = 0;
+
+  // record -> animation it shows now, an invalid handle once it is destroyed
+  std::unordered_map<uint32_t, AnimationHandle> m_tileOverrides;
+
+  ThreadPool *m_threadPool = nullptr;
+  Spawner m_spawner;
+  bool m_synchronous = false;
+
+  PreparedChunk prepare(size_t index) const;
+
+  void request(size_t index);
+
+  void spawn(PreparedChunk prepared);
+
+  void unload(size_t index);
+
+  void waitForPending();
+
+public:
+  LevelStreamer();
+
+  ~LevelStreamer();
+
+  LevelStreamer(const LevelStreamer &) = delete;
+
+  LevelStreamer &operator=(const LevelStreamer &) = delete;
+
+  // opens the compiled level next to fileName if it is up to date, else
+  // parses the text, throws LevelError; nothing is spawned yet
+  void open(const std::string &fileName, ThreadPool *threadPool);
+
+  [[nodiscard]] const PlayerConfig &player() const;
+
+  // animation names used by the level, indexed by EntityRecord::asset
+  [[nodiscard]] const std::vector<std::string> &assetNames() const;
+
+  // handles and sizes per asset name, used to place the entities
+  void setLayout(std::vector<AnimationHandle> animations,
+                 std::vector<Vec2> animationSizes, Vec2 gridSize,
+                 float windowHeight);
+
+  void setSpawner(Spawner spawner);
+
+  // waits for prefetched chunks too, so what is spawned on a frame depends
+  // only on the view and not on the workers; used for record and replay
+  void setSynchronous(bool synchronous);
+
+  // spawns the chunks that cover [viewLeft, viewRight] (waiting for them if
+  // needed), starts preparing the next ones and unloads those far away
+  void update(float viewLeft, float viewRight);
+
+  // unloads every chunk and forgets the changed tiles, the level starts
+  // over on the next update; the chunk entities are left to the caller
+  void reset();
+
+  // remembered for when the tile's chunk is spawned again
+  void destroyTile(uint32_t record);
+
+  void replaceTile(uint32_t record, AnimationHandle animation);
+
+  // takes over the changed tiles of the same level opened before it was
+  // edited, those whose record still describes the same tile
+  void keepChangedTiles(const LevelStreamer &previous);
+
+  [[nodiscard]] size_t residentChunks() const;
+};
+
+#endif // LEVEL_STREAMER_H
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+
+public:
+  MappedFile();
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept;
+
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  // maps the file, returns false if it can not be opened or mapped
+  bool open(const std::string &path);
+
+  void close();
+
+  [[nodiscard]] bool isOpen() const;
+
+  [[nodiscard]] const char *data() const;
+
+  [[nodiscard]] size_t size() const;
+};
+
+#endif // MAPPED_FILE_H
@@ -10,6 +10,15 @@ public:
   Vec2 GetOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b);
 
   Vec2 GetPreviousOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b);
+
+  // the same on bare boxes given by centre and half size, for packed data:
+  // the overlap, zero unless both axes overlap
+  static Vec2 BoxOverlap(const Vec2 &aPosition, const Vec2 &aHalfSize,
+                         const Vec2 &bPosition, const Vec2 &bHalfSize);
+
+  // the overlap on each axis even if negative, which is a gap
+  static Vec2 SignedOverlap(const Vec2 &aPosition, const Vec2 &aHalfSize,
+                            const Vec2 &bPosition, const Vec2 &bHalfSize);
 };
 
 #endif // PHYSICS_H
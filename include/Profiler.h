@@ -0,0 +1,109 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Allocations.h"
+
+// Collects timed zones from every thread into a fixed ring of events. Writers
+// never lock or allocate: a zone takes a slot with one atomic increment and
+// publishes it through the slot's sequence number, so readers skip slots that
+// are being overwritten. Zone names must be string literals. Every zone also
+// carries what its thread allocated while it was open.
+class Profiler {
+public:
+  struct Event {
+    const char *name = nullptr;
+    uint64_t start = 0; // ns since the profiler started
+    uint64_t end = 0;
+    uint32_t thread = 0; // small per thread number, 0 is the first user
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+  };
+
+  struct ZoneStats {
+    std::string name;
+    size_t count = 0;
+    double p50 = 0; // ms
+    double p99 = 0;
+    double max = 0;
+    uint64_t allocations = 0; // over all count events
+    uint64_t bytes = 0;
+  };
+
+private:
+  static constexpr size_t kCapacity = size_t(1) << 16;
+
+  struct Slot {
+    std::atomic<uint64_t> sequence{0}; // 2 * index + 2 once written
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> end{0};
+    std::atomic<uint32_t> thread{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  std::atomic<uint64_t> m_next{0};
+
+  Profiler();
+
+public:
+  static Profiler &instance();
+
+  static uint64_t now();
+
+  static uint32_t threadNumber();
+
+  void record(const char *name, uint64_t start, uint64_t end,
+              uint64_t allocations = 0, uint64_t bytes = 0);
+
+  // the events still in the ring, oldest first
+  [[nodiscard]] std::vector<Event> snapshot() const;
+
+  // per zone durations and allocations of the events that ended in the last
+  // window nanoseconds, sorted by name
+  [[nodiscard]] std::vector<ZoneStats> summarize(uint64_t window) const;
+
+  // one row per event: zone,thread,start_us,duration_us,allocations,bytes
+  bool writeCsv(const std::string &path) const;
+
+  // Chrome trace event JSON, opens in chrome://tracing and Perfetto
+  bool writeTrace(const std::string &path) const;
+};
+
+class ProfileZone {
+  const char *m_name;
+  Allocations::Counts m_allocations;
+  uint64_t m_start;
+
+public:
+  explicit ProfileZone(const char *name)
+      : m_name(name), m_allocations(Allocations::thisThread()),
+        m_start(Profiler::now()) {}
+
+  ~ProfileZone() {
+    const uint64_t end = Profiler::now();
+    const Allocations::Counts allocations = Allocations::thisThread();
+    Profiler::instance().record(m_name, m_start, end,
+                                allocations.count - m_allocations.count,
+                                allocations.bytes - m_allocations.bytes);
+  }
+
+  ProfileZone(const ProfileZone &) = delete;
+
+  ProfileZone &operator=(const ProfileZone &) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// times the rest of the enclosing scope as the zone name
+#define PROFILE_SCOPE(name)                                                    \
+  ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+#endif // PROFILER_H
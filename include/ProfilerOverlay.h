@@ -0,0 +1,39 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include "Assets.h"
+#include "FramePacer.h"
+#include "InputQueue.h"
+#include "SFML/Graphics/RectangleShape.hpp"
+#include "SFML/Graphics/RenderWindow.hpp"
+#include "SFML/Graphics/Text.hpp"
+
+class Scene;
+
+// p50/p99 and allocations per call of every profiler zone over the last
+// seconds, the frame pacing, the input latency and the entity count per
+// tag of the current scene, drawn over the scene. The text is only rebuilt
+// every m_refreshFrames frames.
+class ProfilerOverlay {
+  Assets *m_assets = nullptr;
+  const FramePacer *m_framePacer = nullptr;
+  const InputQueue *m_inputQueue = nullptr;
+  AssetScope m_assetScope; // the font, required the first time it is shown
+  sf::Text m_text;
+  sf::RectangleShape m_background;
+  bool m_visible = false;
+  size_t m_refreshFrames = 30;
+  size_t m_framesUntilRefresh = 0;
+
+  void refresh(Scene &scene);
+
+public:
+  ProfilerOverlay(Assets *assets, const FramePacer *framePacer,
+                  const InputQueue *inputQueue);
+
+  void toggle();
+
+  void draw(sf::RenderWindow &window, Scene &scene);
+};
+
+#endif // PROFILER_OVERLAY_H
@@ -0,0 +1,88 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Action.h"
+
+// thrown when a replay file can not be written, read or is malformed
+class ReplayError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// Recorded play session, written by ReplayRecorder and read by
+// ReplayPlayer. Native endian, a Header followed by Records in the order
+// they happened. Ticks count the updates since a scene became the current
+// one, scenes count how often the current scene changed, so loading taking
+// a different number of frames does not shift the input.
+namespace ReplayFormat {
+constexpr uint32_t kMagic = 0x50524d4d; // "MMRP"
+constexpr uint32_t kVersion = 1;
+
+enum RecordKind : uint8_t { Input = 0, Checksum = 1 };
+
+struct Header {
+  uint32_t magic = kMagic;
+  uint32_t version = kVersion;
+};
+
+// an action sent before the tick's update, or the scene's checksum after it
+struct Record {
+  uint32_t scene = 0;
+  uint32_t tick = 0;
+  uint8_t kind = Input;
+  uint8_t action = 0; // ActionName
+  uint8_t type = 0;   // ActionType
+  uint8_t padding = 0;
+  uint32_t checksum = 0;
+};
+} // namespace ReplayFormat
+
+class ReplayRecorder {
+  std::ofstream m_file;
+
+public:
+  ReplayRecorder();
+
+  // truncates the file and writes the header, throws ReplayError
+  void open(const std::string &path);
+
+  [[nodiscard]] bool isOpen() const;
+
+  void action(uint32_t scene, uint32_t tick, const Action &action);
+
+  void checksum(uint32_t scene, uint32_t tick, uint32_t checksum);
+};
+
+class ReplayPlayer {
+  std::vector<ReplayFormat::Record> m_records;
+  size_t m_next = 0;
+
+  // skips what was recorded before (scene, tick), for ticks the recording
+  // had and this run did not
+  void seek(uint32_t scene, uint32_t tick);
+
+public:
+  ReplayPlayer();
+
+  // reads the whole file, throws ReplayError
+  void open(const std::string &path);
+
+  // every record was played back
+  [[nodiscard]] bool finished() const;
+
+  // the actions recorded for the tick, in the order they came in
+  std::vector<Action> actions(uint32_t scene, uint32_t tick);
+
+  // compares the recorded checksum of the tick, true if they match or the
+  // recording has none for it; expected is set to the recorded one
+  bool verify(uint32_t scene, uint32_t tick, uint32_t checksum,
+              uint32_t &expected);
+};
+
+#endif // REPLAY_H
@@ -1,20 +1,25 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include <array>
 #include <memory>
 
 #include "Action.h"
+#include "Assets.h"
 #include "EntityManager.h"
+#include <SFML/Window/Keyboard.hpp>
 
 class GameEngine;
 
-typedef std::map<int, std::string> ActionMap;
+// dense key code -> action table, ActionName::None for unbound keys
+typedef std::array<ActionName, sf::Keyboard::KeyCount> ActionMap;
 
 class Scene {
 protected:
   GameEngine *m_game = nullptr;
+  AssetScope m_assetScope; // the assets this scene depends on
   EntityManager m_entityManager;
-  ActionMap m_actionMap;
+  ActionMap m_actionMap{};
   bool m_paused = false;
   bool m_hasEnded = false;
   size_t m_currentFrame = 0;
@@ -23,6 +28,9 @@ protected:
 
   void setPaused(bool paused);
 
+  // folds the bytes into a checksum, see checksum()
+  static uint32_t mixChecksum(uint32_t hash, const void *data, size_t size);
+
 public:
   Scene();
 
@@ -38,6 +46,26 @@ public:
 
   virtual void doAction(const Action &action);
 
+  // hot reload, called by the engine after the assets were patched: the
+  // animations that were rebuilt, and every watched file that changed
+  virtual void onAssetsReloaded(const std::vector<AnimationHandle> &animations);
+
+  virtual void onFileChanged(const std::string &path);
+
+  // scene stack, see GameEngine: called when the scene is on top again
+  // after the one above it was popped
+  virtual void onResume();
+
+  // reusable scenes are cached when they finish and reset() before they
+  // are pushed again
+  [[nodiscard]] virtual bool isReusable() const;
+
+  virtual void reset();
+
+  // hash of the entities and their state, recorded and compared every tick
+  // by replays to find where a run diverged
+  [[nodiscard]] virtual uint32_t checksum();
+
   void simulate(size_t frames);
 
   void registerAction(int inputKey, const std::string &actionName);
@@ -48,10 +76,14 @@ public:
 
   [[nodiscard]] size_t currentFrame() const;
 
+  EntityManager &entityManager();
+
   [[nodiscard]] bool hasEnded() const;
 
   [[nodiscard]] const ActionMap &getActionMap() const;
 
+  [[nodiscard]] ActionName actionFor(int inputKey) const;
+
   void drawLine(const Vec2 &p1, const Vec2 &p2);
 };
 
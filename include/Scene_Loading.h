@@ -0,0 +1,46 @@
+#ifndef SCENE_LOADING_H
+#define SCENE_LOADING_H
+
+#include <future>
+#include <string>
+
+#include "AssetManifest.h"
+#include "SFML/Graphics/RectangleShape.hpp"
+#include "Scene.h"
+
+// First scene after the window opens. The manifest is parsed and the menu's
+// font read on the thread pool while this draws a progress bar, which needs
+// no assets at all; the menu takes over as soon as its font is ready.
+// The packed bundle next to the manifest ('make bundle') is picked on the
+// pool as well, while it is at least as new as everything it was packed from.
+class Scene_Loading : public Scene {
+  static constexpr size_t kSteps = 2; // manifest registered, menu font read
+
+  // the parsed manifest and the path to load, it or the bundle
+  struct Source {
+    std::string path;
+    AssetManifest manifest;
+  };
+
+  std::string m_assetsPath;
+  std::future<Source> m_manifest;
+  FontHandle m_menuFont;
+  size_t m_stepsDone = 0;
+  sf::RectangleShape m_progressFrame;
+  sf::RectangleShape m_progressBar;
+
+  void init();
+
+  void update() override;
+
+  void onEnd() override;
+
+  void sDoAction(const Action &action) override;
+
+public:
+  Scene_Loading(GameEngine *gameEngine, const std::string &assetsPath);
+
+  void sRender() override;
+};
+
+#endif // SCENE_LOADING_H
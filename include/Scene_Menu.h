@@ -2,14 +2,25 @@
 #define SCENE_MENU_H
 
 #include <deque>
+#include <future>
 #include <map>
 #include <memory>
 
 #include "EntityManager.h"
+#include "LevelStreamer.h"
 #include "SFML/Graphics/Text.hpp"
 #include "Scene.h"
 
 class Scene_Menu : public Scene {
+  // a level opened in the background while the menu is shown
+  struct LevelPreload {
+    std::future<std::unique_ptr<LevelStreamer>> opening;
+    std::unique_ptr<LevelStreamer> level;
+    std::vector<AnimationHandle> animations; // what playing it acquires
+  };
+
+  static constexpr size_t kNoLevel = size_t(-1);
+
 protected:
   std::string m_title;
   std::vector<std::string> m_menuStrings;
@@ -18,17 +29,37 @@ protected:
   std::vector<sf::Text> m_menuItems;
 
   std::vector<std::string> m_levelPaths;
+  std::vector<LevelPreload> m_preloads; // indexed like m_levelPaths
+  size_t m_prefetched = kNoLevel;       // whose textures are being decoded
+  FontHandle m_font;
+  sf::Text m_helpText;
   size_t m_selectedMenuIndex = 0;
 
   void init();
 
+  void startPreloads();
+
+  std::unique_ptr<LevelStreamer> takePreload(size_t index);
+
+  void sPreload();
+
   void update() override;
 
   void onEnd() override;
 
+  void onResume() override;
+
+  void onFileChanged(const std::string &path) override;
+
+  [[nodiscard]] bool isReusable() const override;
+
+  void reset() override;
+
   void sDoAction(const Action &action) override;
 
 public:
+  static constexpr const char *kFont = "Megaman"; // see Scene_Loading
+
   explicit Scene_Menu(GameEngine *gameEngine = nullptr);
 
   void sRender() override;
@@ -4,50 +4,95 @@
 #include <map>
 #include <memory>
 
+#include "AnimationClock.h"
+#include "AnimationStateMachine.h"
+#include "Contacts.h"
 #include "EntityManager.h"
+#include "Level.h"
+#include "LevelStreamer.h"
 #include "Physics.h"
 #include "SFML/Graphics/Text.hpp"
 #include "Scene.h"
 class Scene_Play : public Scene {
-  struct PlayerConfig {
-    float X, Y, CX, CY, SPEED, MAX_SPEED, JUMP, GRAVITY;
-    std::string WEAPON;
-  };
-
 protected:
   std::shared_ptr<Entity> m_player;
   std::string m_levelPath;
+  std::string m_compiledLevelPath;
   PlayerConfig m_playerConfig;
   bool m_drawTextures = true;
   bool m_drawCollision = false;
   bool m_drawGrid = false;
   const Vec2 m_gridSize = {64, 64};
   sf::Text m_gridText;
+  // sf::Text::setString allocates, so a grid label is only rebuilt when its
+  // column scrolls into view
+  struct GridLabel {
+    int column = -1;
+    sf::Text text;
+  };
+  std::vector<GridLabel> m_gridLabels;
   Physics m_worldPhysics;
-  bool m_playerOnGround = false;
+  // written by sCollision every tick and read by the contact systems after
+  // it, kept to reuse their capacity
+  std::vector<CollisionBox> m_tileBoxes;
+  std::vector<CollisionBox> m_bulletBoxes;
+  std::vector<Contact> m_contacts;
+  AnimationStateMachine m_playerAnimations;
+  AnimationClock m_tileAnimations;
+  std::unique_ptr<LevelStreamer> m_levelStreamer;
+  // resolved once in init/loadLevel, used by the per-frame systems
+  AnimationHandle m_explosionAnimation;
+  AnimationHandle m_weaponAnimation;
   bool m_jumpActive = false;
   bool m_isJumping = false;
   float m_jumpTime = 0.0f;
   float m_maxJumpTime = 0.25f; // seconds of held-jump boost
-  std::string m_playerLookDiraction = "right";
-  bool m_animationIsFlipped = false;
 
-  void init(const std::string &levelPath);
+  void init(const std::string &levelPath,
+            std::unique_ptr<LevelStreamer> level);
+
+  void initPlayerAnimations();
 
   Vec2 gridToMidPixel(float, float, std::shared_ptr<Entity>);
 
-  void loadLevel(const std::string &fileName);
+
+  // opens the level unless an already opened one is given
+  void loadLevel(const std::string &fileName,
+                 std::unique_ptr<LevelStreamer> level = nullptr);
+
+  // hands the level's animations and their sizes to the streamer
+  void layoutLevel();
+
+  std::shared_ptr<Entity> spawnLevelEntity(const ChunkEntity &levelEntity);
+
+  // a fresh entity manager with the pools of the short lived entities
+  void resetEntities();
 
   void spawnPlayer();
 
   void spawnBullet(std::shared_ptr<Entity> entity);
 
+  void breakTile(std::shared_ptr<Entity> tile);
+
+  void bumpTile(std::shared_ptr<Entity> tile);
+
+  [[nodiscard]] float viewCenterX() const;
+
+  void sStreaming();
+
   void sMovement();
 
   void sLifespan();
 
+  // packs the boxes and detects the tick's contacts, writes nothing else
   void sCollision();
 
+  // pushes the player out of solid tiles, emits the Head contacts
+  void sPlayerContacts();
+
+  // destroys the bullets that hit a tile, breaks and bumps the tiles
+  void sTileContacts();
+
   void sAnimation();
 
   void sRender() override;
@@ -56,12 +101,24 @@ protected:
 
   void onEnd() override;
 
+  void onAssetsReloaded(
+      const std::vector<AnimationHandle> &animations) override;
+
+  void onFileChanged(const std::string &path) override;
+
+  [[nodiscard]] bool isReusable() const override;
+
+  void reset() override;
+
+  [[nodiscard]] uint32_t checksum() override;
+
   //    void changePlayerStateTo(PlayerState s);
   //    void spawnCoinSpin(std::shared_ptr<Entity> tile);
   //    void spawnBrickDebris(std::shared_ptr<Entity> tile);
 
 public:
-  Scene_Play(GameEngine *gameEngine, const std::string &levelPath);
+  Scene_Play(GameEngine *gameEngine, const std::string &levelPath,
+             std::unique_ptr<LevelStreamer> level = nullptr);
 
   void update() override;
 };
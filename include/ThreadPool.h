@@ -0,0 +1,52 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs from a shared queue. Used for the
+// CPU side of loading (image decoding, file reads) so the main thread only
+// does the work that needs the OpenGL context.
+class ThreadPool {
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_jobs;
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  bool m_stopping = false;
+
+  void workerLoop();
+
+public:
+  // 0 threads means one less than the number of hardware threads
+  explicit ThreadPool(size_t threadCount = 0);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // queues a job, the returned future rethrows anything the job threw
+  template <class F> auto submit(F &&job) -> std::future<decltype(job())> {
+    typedef decltype(job()) Result;
+    auto task =
+        std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+    std::future<Result> result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_jobs.emplace_back([task]() { (*task)(); });
+    }
+    m_wakeUp.notify_one();
+    return result;
+  }
+
+  [[nodiscard]] size_t size() const;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,28 @@
+#ifndef TILE_PROPERTIES_H
+#define TILE_PROPERTIES_H
+
+#include <cstdint>
+#include <string>
+
+#include "AssetHandle.h"
+
+// gameplay behaviour of a tile type, declared with 'TileType' lines in the
+// assets file and looked up by the tile's animation
+struct TileProperties {
+  enum Flag : uint32_t {
+    Solid = 1 << 0,     // blocks the player
+    Breakable = 1 << 1, // explodes when hit by a bullet or from below
+    Bumpable = 1 << 2,  // changes to 'bumped' when hit from below
+    Goal = 1 << 3,      // touching it ends the run
+  };
+
+  uint32_t flags = Solid;
+  AnimationHandle reward; // spawned above the tile when it is bumped
+  AnimationHandle bumped; // animation the tile changes to when bumped
+
+  // parses a comma separated flag list such as "solid,breakable",
+  // throws AssetError on unknown flags
+  static uint32_t parseFlags(const std::string &list);
+};
+
+#endif // TILE_PROPERTIES_H
@@ -1,12 +1,46 @@
 #include "../include/Action.h"
 
-#include <utility>
+#include <array>
+
+namespace {
+// indexed by ActionName, must follow the order of the enum
+constexpr std::array<const char *, size_t(ActionName::Count)> kActionNames = {
+    "NONE",
+    "UP",
+    "DOWN",
+    "LEFT",
+    "RIGHT",
+    "JUMP",
+    "SHOOT",
+    "PLAY",
+    "QUIT",
+    "PAUSE",
+    "TOGGLE_TEXTURE",
+    "TOGGLE_COLLISION",
+    "TOGGLE_GRID"};
+} // namespace
 
 Action::Action() = default;
 
-Action::Action(std::string name, std::string type)
-    : m_name(std::move(name)), m_type(std::move(type)) {}
+Action::Action(ActionName name, ActionType type)
+    : m_name(name), m_type(type) {}
+
+ActionName Action::name() const { return m_name; }
+
+ActionType Action::type() const { return m_type; }
 
-const std::string &Action::name() const { return m_name; }
+ActionName Action::intern(const std::string &name) {
+  for (size_t i = 1; i < kActionNames.size(); i++) {
+    if (name == kActionNames[i]) {
+      return ActionName(i);
+    }
+  }
+  return ActionName::None;
+}
 
-const std::string &Action::type() const { return m_type; }
+const char *Action::toString(ActionName name) {
+  if (name >= ActionName::Count) {
+    return kActionNames[0];
+  }
+  return kActionNames[size_t(name)];
+}
@@ -0,0 +1,111 @@
+#include "../include/AllocationTest.h"
+#include "../include/Profiler.h"
+#include <iostream>
+
+AllocationTest::AllocationTest() { m_actions.reserve(8); }
+
+const std::vector<Action> &AllocationTest::update(const std::string &sceneName,
+                                                  uint32_t tick) {
+  using Name = ActionName;
+  // the same buffer every tick, so sending actions does not allocate in the
+  // measured frames
+  m_actions.clear();
+  auto press = [this](Name name) {
+    m_actions.emplace_back(name, ActionType::Start);
+  };
+  auto release = [this](Name name) {
+    m_actions.emplace_back(name, ActionType::End);
+  };
+  auto toggleDebugDrawing = [&] {
+    press(Name::ToggleGrid);
+    release(Name::ToggleGrid);
+    press(Name::ToggleCollision);
+    release(Name::ToggleCollision);
+  };
+
+  if (m_phase == Phase::Menu) {
+    if (sceneName == "MENU") {
+      m_phase = Phase::IdleWarmUp;
+      press(Name::Play);
+      release(Name::Play);
+    }
+    return m_actions;
+  }
+  if (sceneName.rfind("PLAY:", 0) != 0) {
+    return m_actions;
+  }
+
+  switch (m_phase) {
+  case Phase::IdleWarmUp:
+    if (tick == 0) {
+      toggleDebugDrawing();
+    }
+    if (tick == kWarmUpFrames) {
+      m_phase = Phase::Idle;
+      m_phaseStart = Profiler::now();
+    }
+    break;
+  case Phase::Idle:
+    if (tick == kWarmUpFrames + kFrames) {
+      check("idle");
+      m_phase = Phase::RunningWarmUp;
+      toggleDebugDrawing();
+      press(Name::Right);
+    }
+    break;
+  case Phase::RunningWarmUp:
+    if (tick == 2 * kWarmUpFrames + kFrames) {
+      m_phase = Phase::Running;
+      m_phaseStart = Profiler::now();
+    }
+    break;
+  case Phase::Running:
+    if (tick == 2 * (kWarmUpFrames + kFrames)) {
+      check("running");
+      m_phase = Phase::Done;
+      release(Name::Right);
+    }
+    break;
+  default:
+    break;
+  }
+
+  // keeps shooting while running, bullets and the explosions of the bricks
+  // they hit come from the entity pools
+  if ((m_phase == Phase::RunningWarmUp || m_phase == Phase::Running) &&
+      tick % kShotInterval == 0) {
+    press(Name::Shoot);
+    release(Name::Shoot);
+  }
+  return m_actions;
+}
+
+void AllocationTest::check(const char *phase) {
+  const auto zones =
+      Profiler::instance().summarize(Profiler::now() - m_phaseStart);
+  uint64_t frame = 0;
+  uint64_t streaming = 0;
+  for (const auto &zone : zones) {
+    if (zone.name == "Frame") {
+      frame = zone.allocations;
+    } else if (zone.name == "sStreaming") {
+      streaming = zone.allocations;
+    }
+  }
+
+  const bool passed = frame <= streaming;
+  m_failed = m_failed || !passed;
+  std::cout << "Allocation test, " << kFrames << " " << phase
+            << " frames: " << (passed ? "passed" : "FAILED") << std::endl;
+  for (const auto &zone : zones) {
+    if (zone.allocations > 0) {
+      std::cout << "  " << zone.name << ": " << zone.allocations
+                << " allocations, " << zone.bytes << " bytes in "
+                << zone.count << " calls" << std::endl;
+    }
+  }
+}
+
+bool AllocationTest::finished() const { return m_phase == Phase::Done; }
+
+bool AllocationTest::failed() const { return m_failed; }
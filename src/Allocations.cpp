@@ -0,0 +1,53 @@
+#include "../include/Allocations.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// plain thread_local integers, so counting never allocates itself
+thread_local uint64_t t_count = 0;
+thread_local uint64_t t_bytes = 0;
+
+void *allocate(std::size_t size, std::size_t alignment) {
+  t_count++;
+  t_bytes += size;
+  if (size == 0) {
+    size = 1;
+  }
+  void *p = nullptr;
+  if (alignment <= alignof(std::max_align_t)) {
+    p = std::malloc(size);
+  } else {
+    // aligned_alloc wants the size to be a multiple of the alignment
+    const std::size_t rounded = (size + alignment - 1) & ~(alignment - 1);
+    p = std::aligned_alloc(alignment, rounded);
+  }
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+} // namespace
+
+Allocations::Counts Allocations::thisThread() {
+  return Counts{t_count, t_bytes};
+}
+
+// the array and nothrow forms forward to these in the standard library
+void *operator new(std::size_t size) {
+  return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return allocate(size, std::size_t(alignment));
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
@@ -24,6 +24,7 @@ Animation::Animation(std::string name, const sf::Texture &t, size_t frameCount,
 void Animation::update(bool flipped) {
   // add the speed variable to the current frame
   if (m_speed == 0 || m_frameCount == 0) {
+    setFlipped(flipped);
     return;
   }
 
@@ -43,8 +44,17 @@ bool Animation::hasEnded() const {
   return (m_currentFrame / m_speed) >= m_frameCount;
 }
 
+void Animation::setFrame(size_t frame) {
+  m_sprite.setTextureRect(
+      sf::IntRect(frame * m_size.x, 0, m_size.x, m_size.y));
+}
+
 const Vec2 &Animation::getSize() const { return m_size; }
 
+size_t Animation::getFrameCount() const { return m_frameCount; }
+
+size_t Animation::getSpeed() const { return m_speed; }
+
 const std::string &Animation::getName() const { return m_name; }
 
 sf::Sprite &Animation::getSprite() { return m_sprite; }
@@ -0,0 +1,39 @@
+#include "../include/AnimationClock.h"
+#include <cassert>
+
+AnimationClock::AnimationClock() = default;
+
+bool AnimationClock::isShareable(const Animation &animation) {
+  return animation.getFrameCount() > 1 && animation.getSpeed() > 0;
+}
+
+size_t AnimationClock::registerClip(const Animation &animation) {
+  assert(isShareable(animation));
+  auto it = m_clipIndex.find(animation.getName());
+  if (it != m_clipIndex.end()) {
+    return it->second;
+  }
+
+  m_clips.push_back({animation, 0});
+  m_clips.back().animation.setFrame(0);
+  m_clipIndex[animation.getName()] = m_clips.size() - 1;
+  return m_clips.size() - 1;
+}
+
+void AnimationClock::update(size_t tick) {
+  for (auto &clip : m_clips) {
+    const size_t frame = (tick / clip.animation.getSpeed()) %
+                         clip.animation.getFrameCount();
+    if (frame != clip.frame) {
+      clip.frame = frame;
+      clip.animation.setFrame(frame);
+    }
+  }
+}
+
+sf::Sprite &AnimationClock::sprite(size_t clip) {
+  assert(clip < m_clips.size());
+  return m_clips[clip].animation.getSprite();
+}
+
+size_t AnimationClock::size() const { return m_clips.size(); }
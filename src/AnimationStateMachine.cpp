@@ -0,0 +1,58 @@
+#include "../include/AnimationStateMachine.h"
+#include <algorithm>
+#include <cassert>
+
+AnimationStateMachine::AnimationStateMachine() = default;
+
+size_t AnimationStateMachine::addState(const Animation &clip) {
+  m_states.push_back({clip, 0, 0});
+  return m_states.size() - 1;
+}
+
+void AnimationStateMachine::addTransition(size_t from, size_t to,
+                                          AnimationCondition condition) {
+  assert(from < m_states.size() && to < m_states.size());
+  m_transitions.push_back({from, to, condition});
+}
+
+void AnimationStateMachine::compile() {
+  // stable sort keeps the priority in which the transitions were added
+  std::stable_sort(m_transitions.begin(), m_transitions.end(),
+                   [](const Transition &a, const Transition &b) {
+                     return a.from < b.from;
+                   });
+
+  for (auto &state : m_states) {
+    state.firstTransition = 0;
+    state.transitionCount = 0;
+  }
+  for (size_t i = m_transitions.size(); i-- > 0;) {
+    auto &state = m_states[m_transitions[i].from];
+    state.firstTransition = i;
+    state.transitionCount++;
+  }
+}
+
+void AnimationStateMachine::update(CState &state, CAnimation &animation,
+                                   bool flipped) const {
+  assert(state.animationState < m_states.size());
+  const State &current = m_states[state.animationState];
+  const size_t end = current.firstTransition + current.transitionCount;
+
+  for (size_t i = current.firstTransition; i < end; i++) {
+    const Transition &transition = m_transitions[i];
+    if ((state.flags & transition.condition.mask) ==
+        transition.condition.value) {
+      state.animationState = transition.to;
+      animation.animation = m_states[transition.to].clip;
+      break;
+    }
+  }
+
+  animation.animation.update(flipped);
+}
+
+const Animation &AnimationStateMachine::clip(size_t state) const {
+  assert(state < m_states.size());
+  return m_states[state].clip;
+}
@@ -0,0 +1,239 @@
+#include "../include/AssetBundle.h"
+#include "../include/AssetManifest.h"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+using namespace AssetBundle;
+
+namespace {
+size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+AssetBundleWriter::AssetBundleWriter() = default;
+
+uint32_t AssetBundleWriter::addString(const std::string &s) {
+  const auto offset = uint32_t(m_strings.size());
+  m_strings.insert(m_strings.end(), s.begin(), s.end());
+  m_strings.push_back('\0');
+  return offset;
+}
+
+uint32_t AssetBundleWriter::addData(const void *data, size_t size) {
+  m_data.resize(alignUp(m_data.size(), 16));
+  const auto offset = uint32_t(m_data.size());
+  const char *bytes = static_cast<const char *>(data);
+  m_data.insert(m_data.end(), bytes, bytes + size);
+  return offset;
+}
+
+uint32_t AssetBundleWriter::addTexture(const std::string &name, uint32_t width,
+                                       uint32_t height, const uint8_t *rgba) {
+  TextureRecord record;
+  record.name = addString(name);
+  record.width = width;
+  record.height = height;
+  record.pixelsOffset = addData(rgba, size_t(width) * height * 4);
+  m_textures.push_back(record);
+  return uint32_t(m_textures.size() - 1);
+}
+
+uint32_t AssetBundleWriter::addAnimation(const std::string &name,
+                                         uint32_t texture, uint32_t frameCount,
+                                         uint32_t speed) {
+  assert(texture < m_textures.size());
+  m_animations.push_back({addString(name), texture, frameCount, speed});
+  return uint32_t(m_animations.size() - 1);
+}
+
+uint32_t AssetBundleWriter::addFont(const std::string &name,
+                                    const std::vector<char> &data) {
+  FontRecord record;
+  record.name = addString(name);
+  record.dataOffset = addData(data.data(), data.size());
+  record.dataSize = uint32_t(data.size());
+  m_fonts.push_back(record);
+  return uint32_t(m_fonts.size() - 1);
+}
+
+void AssetBundleWriter::addTileType(uint32_t animation, uint32_t flags,
+                                    uint32_t reward, uint32_t bumped) {
+  assert(animation < m_animations.size());
+  m_tileTypes.push_back({animation, flags, reward, bumped});
+}
+
+void AssetBundleWriter::writeToFile(const std::string &path) const {
+  Header header;
+  header.textureCount = uint32_t(m_textures.size());
+  header.animationCount = uint32_t(m_animations.size());
+  header.fontCount = uint32_t(m_fonts.size());
+  header.tileTypeCount = uint32_t(m_tileTypes.size());
+
+  size_t offset = sizeof(Header);
+  header.texturesOffset = uint32_t(offset);
+  offset += m_textures.size() * sizeof(TextureRecord);
+  header.animationsOffset = uint32_t(offset);
+  offset += m_animations.size() * sizeof(AnimationRecord);
+  header.fontsOffset = uint32_t(offset);
+  offset += m_fonts.size() * sizeof(FontRecord);
+  header.tileTypesOffset = uint32_t(offset);
+  offset += m_tileTypes.size() * sizeof(TileTypeRecord);
+  header.stringsOffset = uint32_t(offset);
+  header.stringsSize = uint32_t(m_strings.size());
+  offset += m_strings.size();
+  const size_t dataOffset = alignUp(offset, 16);
+  if (dataOffset + m_data.size() > UINT32_MAX) {
+    throw AssetError("Asset bundle is too large: " + path);
+  }
+
+  // data offsets were recorded relative to the data section
+  std::vector<TextureRecord> textures = m_textures;
+  for (auto &texture : textures) {
+    texture.pixelsOffset += uint32_t(dataOffset);
+  }
+  std::vector<FontRecord> fonts = m_fonts;
+  for (auto &font : fonts) {
+    font.dataOffset += uint32_t(dataOffset);
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw AssetError("Could not write asset bundle: " + path);
+  }
+  auto write = [&file](const void *data, size_t size) {
+    file.write(static_cast<const char *>(data), std::streamsize(size));
+  };
+  write(&header, sizeof(header));
+  write(textures.data(), textures.size() * sizeof(TextureRecord));
+  write(m_animations.data(), m_animations.size() * sizeof(AnimationRecord));
+  write(fonts.data(), fonts.size() * sizeof(FontRecord));
+  write(m_tileTypes.data(), m_tileTypes.size() * sizeof(TileTypeRecord));
+  write(m_strings.data(), m_strings.size());
+  const std::vector<char> padding(dataOffset - offset, '\0');
+  write(padding.data(), padding.size());
+  write(m_data.data(), m_data.size());
+
+  if (!file) {
+    throw AssetError("Could not write asset bundle: " + path);
+  }
+}
+
+AssetBundleReader::AssetBundleReader() = default;
+
+template <class T>
+const T &AssetBundleReader::record(uint32_t tableOffset, uint32_t i) const {
+  return reinterpret_cast<const T *>(m_file.data() + tableOffset)[i];
+}
+
+void AssetBundleReader::open(const std::string &path) {
+  m_header = nullptr;
+  if (!m_file.open(path)) {
+    throw AssetError("Could not map asset bundle: " + path);
+  }
+
+  const size_t size = m_file.size();
+  auto inside = [size](size_t offset, size_t length) {
+    return offset <= size && length <= size - offset;
+  };
+
+  const auto *header = reinterpret_cast<const Header *>(m_file.data());
+  if (!inside(0, sizeof(Header)) || header->magic != kMagic ||
+      header->version != kVersion) {
+    throw AssetError("Not a version " + std::to_string(kVersion) +
+                     " asset bundle: " + path);
+  }
+
+  const bool tablesInside =
+      inside(header->texturesOffset,
+             size_t(header->textureCount) * sizeof(TextureRecord)) &&
+      inside(header->animationsOffset,
+             size_t(header->animationCount) * sizeof(AnimationRecord)) &&
+      inside(header->fontsOffset,
+             size_t(header->fontCount) * sizeof(FontRecord)) &&
+      inside(header->tileTypesOffset,
+             size_t(header->tileTypeCount) * sizeof(TileTypeRecord)) &&
+      inside(header->stringsOffset, header->stringsSize) &&
+      header->stringsSize > 0 &&
+      m_file.data()[header->stringsOffset + header->stringsSize - 1] == '\0';
+  if (!tablesInside) {
+    throw AssetError("Corrupt asset bundle tables: " + path);
+  }
+  m_header = header;
+
+  // every payload and reference has to stay inside the mapping
+  for (uint32_t i = 0; i < header->textureCount; i++) {
+    const auto &entry = texture(i);
+    if (entry.name >= header->stringsSize ||
+        !inside(entry.pixelsOffset,
+                size_t(entry.width) * entry.height * 4)) {
+      m_header = nullptr;
+      throw AssetError("Corrupt texture record in asset bundle: " + path);
+    }
+  }
+  for (uint32_t i = 0; i < header->animationCount; i++) {
+    const auto &entry = animation(i);
+    if (entry.name >= header->stringsSize ||
+        entry.texture >= header->textureCount || entry.frameCount == 0) {
+      m_header = nullptr;
+      throw AssetError("Corrupt animation record in asset bundle: " + path);
+    }
+  }
+  for (uint32_t i = 0; i < header->fontCount; i++) {
+    const auto &entry = font(i);
+    if (entry.name >= header->stringsSize ||
+        !inside(entry.dataOffset, entry.dataSize)) {
+      m_header = nullptr;
+      throw AssetError("Corrupt font record in asset bundle: " + path);
+    }
+  }
+  for (uint32_t i = 0; i < header->tileTypeCount; i++) {
+    const auto &entry = tileType(i);
+    auto validAnimation = [header](uint32_t index) {
+      return index == kNone || index < header->animationCount;
+    };
+    if (entry.animation >= header->animationCount ||
+        !validAnimation(entry.reward) || !validAnimation(entry.bumped)) {
+      m_header = nullptr;
+      throw AssetError("Corrupt tile type record in asset bundle: " + path);
+    }
+  }
+}
+
+bool AssetBundleReader::isOpen() const { return m_header != nullptr; }
+
+const Header &AssetBundleReader::header() const {
+  assert(m_header != nullptr);
+  return *m_header;
+}
+
+const TextureRecord &AssetBundleReader::texture(uint32_t i) const {
+  assert(i < m_header->textureCount);
+  return record<TextureRecord>(m_header->texturesOffset, i);
+}
+
+const AnimationRecord &AssetBundleReader::animation(uint32_t i) const {
+  assert(i < m_header->animationCount);
+  return record<AnimationRecord>(m_header->animationsOffset, i);
+}
+
+const FontRecord &AssetBundleReader::font(uint32_t i) const {
+  assert(i < m_header->fontCount);
+  return record<FontRecord>(m_header->fontsOffset, i);
+}
+
+const TileTypeRecord &AssetBundleReader::tileType(uint32_t i) const {
+  assert(i < m_header->tileTypeCount);
+  return record<TileTypeRecord>(m_header->tileTypesOffset, i);
+}
+
+const char *AssetBundleReader::string(uint32_t offset) const {
+  assert(offset < m_header->stringsSize);
+  return m_file.data() + m_header->stringsOffset + offset;
+}
+
+const char *AssetBundleReader::data(uint32_t offset) const {
+  assert(offset < m_file.size());
+  return m_file.data() + offset;
+}
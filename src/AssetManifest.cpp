@@ -0,0 +1,38 @@
+#include "../include/AssetManifest.h"
+#include <fstream>
+
+AssetManifest::AssetManifest() = default;
+
+void AssetManifest::loadFromFile(const std::string &path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw AssetError("Could not load " + path + " file!");
+  }
+
+  std::string assetType;
+  while (file >> assetType) {
+    if (assetType == "Texture") {
+      TextureEntry entry;
+      file >> entry.name >> entry.path;
+      textures.push_back(entry);
+    } else if (assetType == "Animation") {
+      AnimationEntry entry;
+      file >> entry.name >> entry.texture >> entry.frameCount >> entry.speed;
+      animations.push_back(entry);
+    } else if (assetType == "Font") {
+      FontEntry entry;
+      file >> entry.name >> entry.path;
+      fonts.push_back(entry);
+    } else if (assetType == "TileType") {
+      TileTypeEntry entry;
+      file >> entry.animation >> entry.flags >> entry.reward >> entry.bumped;
+      tileTypes.push_back(entry);
+    } else {
+      throw AssetError("Incorrect asset type: " + assetType + " in " + path);
+    }
+
+    if (!file) {
+      throw AssetError("Malformed " + assetType + " line in " + path);
+    }
+  }
+}
@@ -1,76 +1,877 @@
 #include "../include/Assets.h"
+#include "../include/Profiler.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <fstream>
-#include <iostream>
+#include <iterator>
+
+namespace {
+// runs the job on the pool, or right here when there is no pool
+template <class F>
+auto runJob(ThreadPool *pool, F &&job) -> std::future<decltype(job())> {
+  if (pool != nullptr) {
+    return pool->submit(std::forward<F>(job));
+  }
+  std::packaged_task<decltype(job())()> task(std::forward<F>(job));
+  auto result = task.get_future();
+  task();
+  return result;
+}
+
+sf::Image decodeImage(const std::string &path) {
+  PROFILE_SCOPE("Assets::decodeImage");
+  sf::Image image;
+  if (!image.loadFromFile(path)) {
+    throw AssetError("Could not load image: " + path + "!");
+  }
+  return image;
+}
+
+std::vector<char> readFile(const std::string &path) {
+  PROFILE_SCOPE("Assets::readFile");
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw AssetError("Could not read file: " + path);
+  }
+  return std::vector<char>(std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>());
+}
+} // namespace
 
 Assets::Assets() = default;
 
+void Assets::setThreadPool(ThreadPool *threadPool) {
+  m_threadPool = threadPool;
+}
+
+void Assets::setMemoryBudget(size_t bytes) {
+  m_memoryBudget = bytes;
+  evictUnused();
+}
+
+bool Assets::isBundle(const std::string &path) {
+  const std::string bundleExtension = ".bundle";
+  return path.size() > bundleExtension.size() &&
+         path.compare(path.size() - bundleExtension.size(),
+                      bundleExtension.size(), bundleExtension) == 0;
+}
+
 void Assets::loadFromFile(const std::string &path) {
-  std::ifstream file(path);
-  if (!file) {
-    std::cerr << "Could not load " << path << " file!\n";
-    exit(-1);
-  }
-
-  std::string assetType;
-  while (file >> assetType) {
-    if (assetType == "Texture") {
-      std::string name;
-      std::string imageFile;
-      file >> name >> imageFile;
-      addTexture(name, imageFile);
-    } else if (assetType == "Animation") {
-      std::string aniName;
-      std::string texName;
-      int frames, speed;
-      file >> aniName >> texName >> frames >> speed;
-      const sf::Texture &tex = getTexture(texName);
-      addAnimation(aniName, Animation(aniName, tex, frames, speed));
-    } else if (assetType == "Font") {
-      std::string fontName;
-      std::string fontPath;
-      file >> fontName >> fontPath;
-      addFont(fontName, fontPath);
-    } else {
-      std::cerr << "Incorrect asset type: " << assetType << "\n";
-      exit(-1);
+  if (isBundle(path)) {
+    loadFromBundle(path);
+    return;
+  }
+
+  AssetManifest manifest;
+  manifest.loadFromFile(path);
+  load(manifest);
+}
+
+void Assets::load(const AssetManifest &manifest) {
+  for (const auto &entry : manifest.textures) {
+    addTexture(entry.name, entry.path);
+  }
+  for (const auto &entry : manifest.fonts) {
+    addFont(entry.name, entry.path);
+  }
+  for (const auto &entry : manifest.animations) {
+    addAnimation(entry.name, entry.texture, entry.frameCount, entry.speed);
+  }
+
+  for (const auto &entry : manifest.tileTypes) {
+    TileProperties properties;
+    properties.flags = TileProperties::parseFlags(entry.flags);
+    if (entry.reward != "-") {
+      properties.reward = getAnimationHandle(entry.reward);
+    }
+    if (entry.bumped != "-") {
+      properties.bumped = getAnimationHandle(entry.bumped);
+    }
+    setTileProperties(getAnimationHandle(entry.animation), properties);
+  }
+}
+
+void Assets::loadFromBundle(const std::string &path) {
+  m_bundle.open(path);
+  const AssetBundle::Header &header = m_bundle.header();
+
+  for (uint32_t i = 0; i < header.textureCount; i++) {
+    const std::string name = m_bundle.string(m_bundle.texture(i).name);
+    addTexture(name, "");
+    m_textureSlots[getTextureHandle(name).index].bundleRecord = i;
+  }
+  for (uint32_t i = 0; i < header.fontCount; i++) {
+    const std::string name = m_bundle.string(m_bundle.font(i).name);
+    addFont(name, "");
+    m_fontSlots[getFontHandle(name).index].bundleRecord = i;
+  }
+
+  // bundle indices map to handles, names may already be registered
+  std::vector<AnimationHandle> animations(header.animationCount);
+  for (uint32_t i = 0; i < header.animationCount; i++) {
+    const auto &record = m_bundle.animation(i);
+    const std::string name = m_bundle.string(record.name);
+    addAnimation(name, m_bundle.string(m_bundle.texture(record.texture).name),
+                 record.frameCount, record.speed);
+    animations[i] = getAnimationHandle(name);
+  }
+  for (uint32_t i = 0; i < header.tileTypeCount; i++) {
+    const auto &record = m_bundle.tileType(i);
+    TileProperties properties;
+    properties.flags = record.flags;
+    if (record.reward != AssetBundle::kNone) {
+      properties.reward = animations[record.reward];
+    }
+    if (record.bumped != AssetBundle::kNone) {
+      properties.bumped = animations[record.bumped];
     }
+    setTileProperties(animations[record.animation], properties);
   }
 }
 
 void Assets::addTexture(const std::string &name, const std::string &path) {
-  sf::Texture texture;
-  if (!texture.loadFromFile(path)) {
-    std::cerr << "Could not load image: " << path << "!\n";
-    exit(-1);
+  auto it = m_textureMap.find(name);
+  if (it != m_textureMap.end()) {
+    auto &slot = m_textureSlots[it->second.index];
+    slot.path = path;
+    slot.bundleRecord = AssetBundle::kNone;
+    return;
   }
-  m_textureMap[name] = texture;
+  m_textureMap[name] = TextureHandle(m_textures.size());
+  m_textures.emplace_back();
+  m_textureSlots.push_back({path});
 }
 
-void Assets::addAnimation(const std::string &name, const Animation &animation) {
-  m_animationMap[name] = animation;
+void Assets::addAnimation(const std::string &name, const std::string &texture,
+                          size_t frameCount, size_t speed) {
+  AnimationSlot slot;
+  slot.name = name;
+  slot.texture = getTextureHandle(texture);
+  slot.frameCount = frameCount;
+  slot.speed = speed;
+
+  auto it = m_animationMap.find(name);
+  if (it != m_animationMap.end()) {
+    auto &existing = m_animationSlots[it->second.index];
+    slot.users = existing.users;
+    existing = slot;
+    return;
+  }
+  m_animationMap[name] = AnimationHandle(m_animations.size());
+  m_animations.emplace_back();
+  m_animationSlots.push_back(slot);
+  m_tileProperties.emplace_back();
 }
 
 void Assets::addFont(const std::string &name, const std::string &path) {
-  sf::Font font;
-  if (!font.loadFromFile(path)) {
-    std::cerr << "Could not load font: " << path << "\n";
-    exit(-1);
+  auto it = m_fontMap.find(name);
+  if (it != m_fontMap.end()) {
+    auto &slot = m_fontSlots[it->second.index];
+    slot.path = path;
+    slot.bundleRecord = AssetBundle::kNone;
+    return;
+  }
+  m_fontMap[name] = FontHandle(m_fonts.size());
+  m_fonts.emplace_back();
+  m_fontData.emplace_back();
+  m_fontSlots.push_back({path});
+}
+
+void Assets::setTileProperties(AnimationHandle animation,
+                               const TileProperties &properties) {
+  assert(animation.index < m_tileProperties.size());
+  m_tileProperties[animation.index] = properties;
+}
+
+void Assets::loadTextures(const std::vector<TextureHandle> &textures) {
+  // decoding does not need the GL context, so it runs on the pool while
+  // this thread waits to upload in order
+  std::vector<std::shared_future<sf::Image>> images(textures.size());
+  for (size_t i = 0; i < textures.size(); i++) {
+    TextureSlot &slot = m_textureSlots[textures[i].index];
+    if (slot.bundleRecord == AssetBundle::kNone) {
+      if (!slot.decoding.valid()) {
+        slot.decoding = runJob(m_threadPool, [path = slot.path]() {
+                          return decodeImage(path);
+                        }).share();
+      }
+      images[i] = std::move(slot.decoding);
+    }
+  }
+
+  for (size_t i = 0; i < textures.size(); i++) {
+    TextureSlot &slot = m_textureSlots[textures[i].index];
+    sf::Texture &texture = m_textures[textures[i].index];
+    if (slot.bundleRecord != AssetBundle::kNone) {
+      const auto &record = m_bundle.texture(slot.bundleRecord);
+      if (!texture.create(record.width, record.height)) {
+        throw AssetError("Could not create texture: " +
+                         std::string(m_bundle.string(record.name)) + "!");
+      }
+      texture.update(reinterpret_cast<const uint8_t *>(
+          m_bundle.data(record.pixelsOffset)));
+    } else if (!texture.loadFromImage(images[i].get())) {
+      throw AssetError("Could not create texture: " + slot.path + "!");
+    }
+
+    slot.bytes = size_t(texture.getSize().x) * texture.getSize().y * 4;
+    slot.resident = true;
+    m_residentBytes += slot.bytes;
+    m_unusedBytes += slot.bytes; // until acquire counts the first user
+  }
+}
+
+void Assets::loadFont(FontHandle handle) {
+  PROFILE_SCOPE("Assets::loadFont");
+  FontSlot &slot = m_fontSlots[handle.index];
+  sf::Font &font = m_fonts[handle.index];
+  if (slot.bundleRecord != AssetBundle::kNone) {
+    // the font reads glyphs straight from the mapping
+    const auto &record = m_bundle.font(slot.bundleRecord);
+    slot.bytes = record.dataSize;
+    if (!font.loadFromMemory(m_bundle.data(record.dataOffset),
+                             record.dataSize)) {
+      throw AssetError("Could not load font: " +
+                       std::string(m_bundle.string(record.name)));
+    }
+  } else {
+    // the font keeps reading glyphs from the buffer, so it lives next to
+    // it; a reloaded font's old buffer is only replaced once the face
+    // reading from it is gone
+    std::vector<char> bytes;
+    if (slot.reading.valid()) {
+      bytes = slot.reading.get();
+      slot.reading = {};
+    } else {
+      bytes = readFile(slot.path);
+    }
+    slot.bytes = bytes.size();
+    if (!font.loadFromMemory(bytes.data(), bytes.size())) {
+      throw AssetError("Could not load font: " + slot.path);
+    }
+    m_fontData[handle.index] = std::move(bytes);
+  }
+
+  slot.resident = true;
+  m_residentBytes += slot.bytes;
+  m_unusedBytes += slot.bytes;
+}
+
+void Assets::buildAnimation(AnimationHandle handle) {
+  AnimationSlot &slot = m_animationSlots[handle.index];
+  m_animations[handle.index] =
+      Animation(slot.name, m_textures[slot.texture.index], slot.frameCount,
+                slot.speed);
+  slot.built = true;
+}
+
+void Assets::prefetch(const std::vector<AnimationHandle> &animations) {
+  std::vector<TextureHandle> textures;
+  for (const auto animation : animations) {
+    assert(animation.index < m_animationSlots.size());
+    const TextureHandle texture = m_animationSlots[animation.index].texture;
+    TextureSlot &slot = m_textureSlots[texture.index];
+    if (!slot.resident && slot.bundleRecord == AssetBundle::kNone &&
+        std::find(textures.begin(), textures.end(), texture) ==
+            textures.end()) {
+      textures.push_back(texture);
+      if (!slot.decoding.valid()) {
+        slot.decoding = runJob(m_threadPool, [path = slot.path]() {
+                          return decodeImage(path);
+                        }).share();
+      }
+    }
+  }
+
+  // decoded images are not counted against the memory budget, so only
+  // one batch of them is kept waiting for its acquire
+  for (const auto texture : m_prefetched) {
+    TextureSlot &slot = m_textureSlots[texture.index];
+    if (!slot.resident &&
+        std::find(textures.begin(), textures.end(), texture) ==
+            textures.end()) {
+      slot.decoding = {};
+    }
+  }
+  m_prefetched = std::move(textures);
+}
+
+void Assets::prefetch(FontHandle font) {
+  assert(font.index < m_fontSlots.size());
+  FontSlot &slot = m_fontSlots[font.index];
+  if (!slot.resident && !slot.reading.valid() &&
+      slot.bundleRecord == AssetBundle::kNone) {
+    slot.reading =
+        runJob(m_threadPool, [path = slot.path]() { return readFile(path); })
+            .share();
+  }
+}
+
+bool Assets::isReady(FontHandle font) const {
+  const FontSlot &slot = m_fontSlots[font.index];
+  if (slot.resident || slot.bundleRecord != AssetBundle::kNone) {
+    return true;
+  }
+  return slot.reading.valid() &&
+         slot.reading.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+}
+
+void Assets::acquire(const std::vector<AnimationHandle> &animations) {
+  PROFILE_SCOPE("Assets::acquire");
+  std::vector<TextureHandle> missing;
+  for (const auto animation : animations) {
+    assert(animation.index < m_animationSlots.size());
+    const TextureHandle texture = m_animationSlots[animation.index].texture;
+    if (!m_textureSlots[texture.index].resident &&
+        std::find(missing.begin(), missing.end(), texture) == missing.end()) {
+      missing.push_back(texture);
+    }
+  }
+  loadTextures(missing);
+
+  for (const auto animation : animations) {
+    AnimationSlot &slot = m_animationSlots[animation.index];
+    TextureSlot &texture = m_textureSlots[slot.texture.index];
+    if (texture.users++ == 0) {
+      m_unusedBytes -= texture.bytes;
+    }
+    slot.users++;
+    if (!slot.built) {
+      buildAnimation(animation);
+    }
+  }
+}
+
+void Assets::acquire(FontHandle font) {
+  assert(font.index < m_fontSlots.size());
+  FontSlot &slot = m_fontSlots[font.index];
+  if (!slot.resident) {
+    loadFont(font);
+  }
+  if (slot.users++ == 0) {
+    m_unusedBytes -= slot.bytes;
   }
-  m_fontMap[name] = font;
 }
 
-const sf::Texture &Assets::getTexture(const std::string &name) const {
-  assert(m_textureMap.find(name) != m_textureMap.end());
-  return m_textureMap.at(name);
+void Assets::release(AnimationHandle animation) {
+  AnimationSlot &slot = m_animationSlots[animation.index];
+  TextureSlot &texture = m_textureSlots[slot.texture.index];
+  assert(slot.users > 0 && texture.users > 0);
+  slot.users--;
+  if (--texture.users == 0) {
+    texture.lastUsed = ++m_useCounter;
+    m_unusedBytes += texture.bytes;
+    evictUnused();
+  }
+}
+
+void Assets::release(FontHandle font) {
+  FontSlot &slot = m_fontSlots[font.index];
+  assert(slot.users > 0);
+  if (--slot.users == 0) {
+    slot.lastUsed = ++m_useCounter;
+    m_unusedBytes += slot.bytes;
+    evictUnused();
+  }
+}
+
+void Assets::reloadTexture(TextureHandle handle) {
+  TextureSlot &slot = m_textureSlots[handle.index];
+  // decoded before anything changes, a half written file throws here
+  const sf::Image image = decodeImage(slot.path);
+  sf::Texture &texture = m_textures[handle.index];
+  if (!texture.loadFromImage(image)) {
+    throw AssetError("Could not create texture: " + slot.path + "!");
+  }
+
+  const size_t bytes = size_t(texture.getSize().x) * texture.getSize().y * 4;
+  m_residentBytes = m_residentBytes - slot.bytes + bytes;
+  if (slot.users == 0) {
+    m_unusedBytes = m_unusedBytes - slot.bytes + bytes;
+  }
+  slot.bytes = bytes;
+}
+
+void Assets::reloadFont(FontHandle handle) {
+  FontSlot &slot = m_fontSlots[handle.index];
+  // loadFont counts the font as new and unused
+  m_residentBytes -= slot.bytes;
+  m_unusedBytes -= slot.bytes;
+  loadFont(handle);
+  if (slot.users > 0) {
+    m_unusedBytes -= slot.bytes;
+  }
+}
+
+void Assets::retarget(AnimationHandle handle, TextureHandle texture) {
+  AnimationSlot &slot = m_animationSlots[handle.index];
+  if (slot.users > 0) {
+    if (!m_textureSlots[texture.index].resident) {
+      loadTextures({texture});
+    }
+    TextureSlot &next = m_textureSlots[texture.index];
+    if (next.users == 0) {
+      m_unusedBytes -= next.bytes;
+    }
+    next.users += slot.users;
+
+    TextureSlot &previous = m_textureSlots[slot.texture.index];
+    previous.users -= slot.users;
+    if (previous.users == 0) {
+      previous.lastUsed = ++m_useCounter;
+      m_unusedBytes += previous.bytes;
+    }
+  }
+  slot.texture = texture;
+}
+
+void Assets::rebuildAnimations(const std::vector<TextureHandle> &textures,
+                               std::vector<AnimationHandle> &rebuilt) {
+  for (size_t i = 0; i < m_animationSlots.size(); i++) {
+    const AnimationSlot &slot = m_animationSlots[i];
+    const AnimationHandle handle(i);
+    if (slot.built &&
+        std::find(textures.begin(), textures.end(), slot.texture) !=
+            textures.end() &&
+        std::find(rebuilt.begin(), rebuilt.end(), handle) == rebuilt.end()) {
+      buildAnimation(handle);
+      rebuilt.push_back(handle);
+    }
+  }
+}
+
+std::vector<AnimationHandle>
+Assets::reloadManifest(const std::string &path) {
+  // Everything that can fail runs before the catalogue changes: the
+  // manifest is parsed, every name resolved, and every image and font read
+  // into objects of its own. A manifest saved half way through or naming a
+  // missing file leaves everything as it was.
+  AssetManifest manifest;
+  manifest.loadFromFile(path);
+
+  // the names and texture paths as they will be after the reload, new
+  // entries get the handles adding them will give them
+  std::map<std::string, TextureHandle> textureMap = m_textureMap;
+  std::vector<std::string> texturePaths;
+  texturePaths.reserve(m_textureSlots.size() + manifest.textures.size());
+  for (const auto &slot : m_textureSlots) {
+    texturePaths.push_back(slot.path);
+  }
+  for (const auto &entry : manifest.textures) {
+    auto [it, added] =
+        textureMap.try_emplace(entry.name, TextureHandle(texturePaths.size()));
+    if (added) {
+      texturePaths.push_back(entry.path);
+    } else {
+      texturePaths[it->second.index] = entry.path;
+    }
+  }
+
+  std::map<std::string, AnimationHandle> animationMap = m_animationMap;
+  std::vector<TextureHandle> animationTextures;
+  animationTextures.reserve(manifest.animations.size());
+  size_t animationCount = m_animationSlots.size();
+  for (const auto &entry : manifest.animations) {
+    auto it = textureMap.find(entry.texture);
+    if (it == textureMap.end()) {
+      throw AssetError("Unknown texture: " + entry.texture);
+    }
+    animationTextures.push_back(it->second);
+    if (animationMap.try_emplace(entry.name, AnimationHandle(animationCount))
+            .second) {
+      animationCount++;
+    }
+  }
+
+  auto animationHandle = [&animationMap](const std::string &name) {
+    auto it = animationMap.find(name);
+    if (it == animationMap.end()) {
+      throw AssetError("Unknown animation: " + name);
+    }
+    return it->second;
+  };
+  std::vector<std::pair<AnimationHandle, TileProperties>> tileTypes;
+  tileTypes.reserve(manifest.tileTypes.size());
+  for (const auto &entry : manifest.tileTypes) {
+    TileProperties properties;
+    properties.flags = TileProperties::parseFlags(entry.flags);
+    if (entry.reward != "-") {
+      properties.reward = animationHandle(entry.reward);
+    }
+    if (entry.bumped != "-") {
+      properties.bumped = animationHandle(entry.bumped);
+    }
+    tileTypes.emplace_back(animationHandle(entry.animation), properties);
+  }
+
+  // resident textures whose file changed, and textures animations in use
+  // move to, are uploaded into textures of their own and swapped in below
+  std::vector<TextureHandle> uploaded;
+  std::deque<sf::Texture> uploads;
+  auto upload = [&](TextureHandle handle) {
+    if (std::find(uploaded.begin(), uploaded.end(), handle) !=
+        uploaded.end()) {
+      return;
+    }
+    const std::string &file = texturePaths[handle.index];
+    const sf::Image image = decodeImage(file);
+    if (!uploads.emplace_back().loadFromImage(image)) {
+      throw AssetError("Could not create texture: " + file + "!");
+    }
+    uploaded.push_back(handle);
+  };
+  for (size_t i = 0; i < m_textureSlots.size(); i++) {
+    if (m_textureSlots[i].resident &&
+        m_textureSlots[i].path != texturePaths[i]) {
+      upload(TextureHandle(i));
+    }
+  }
+  for (size_t i = 0; i < manifest.animations.size(); i++) {
+    auto it = m_animationMap.find(manifest.animations[i].name);
+    const TextureHandle texture = animationTextures[i];
+    if (it != m_animationMap.end() &&
+        m_animationSlots[it->second.index].users > 0 &&
+        (texture.index >= m_textureSlots.size() ||
+         !m_textureSlots[texture.index].resident)) {
+      upload(texture);
+    }
+  }
+
+  // fonts read from the buffer they were loaded from, so both move in
+  std::vector<FontHandle> reloadedFonts;
+  std::deque<sf::Font> fonts;
+  std::deque<std::vector<char>> fontData;
+  for (const auto &entry : manifest.fonts) {
+    auto it = m_fontMap.find(entry.name);
+    if (it == m_fontMap.end() || !m_fontSlots[it->second.index].resident ||
+        m_fontSlots[it->second.index].path == entry.path) {
+      continue;
+    }
+    const std::vector<char> &bytes =
+        fontData.emplace_back(readFile(entry.path));
+    if (!fonts.emplace_back().loadFromMemory(bytes.data(), bytes.size())) {
+      throw AssetError("Could not load font: " + entry.path);
+    }
+    reloadedFonts.push_back(it->second);
+  }
+
+  // nothing below can fail
+  for (const auto &entry : manifest.textures) {
+    auto it = m_textureMap.find(entry.name);
+    if (it == m_textureMap.end()) {
+      addTexture(entry.name, entry.path);
+    } else if (m_textureSlots[it->second.index].path != entry.path) {
+      m_textureSlots[it->second.index].path = entry.path;
+      m_textureSlots[it->second.index].decoding = {};
+    }
+  }
+
+  std::vector<TextureHandle> changedTextures;
+  for (size_t i = 0; i < uploaded.size(); i++) {
+    TextureSlot &slot = m_textureSlots[uploaded[i].index];
+    sf::Texture &texture = m_textures[uploaded[i].index];
+    texture.swap(uploads[i]);
+    slot.decoding = {};
+    const size_t bytes = size_t(texture.getSize().x) * texture.getSize().y * 4;
+    if (slot.resident) {
+      m_residentBytes = m_residentBytes - slot.bytes + bytes;
+      if (slot.users == 0) {
+        m_unusedBytes = m_unusedBytes - slot.bytes + bytes;
+      }
+      changedTextures.push_back(uploaded[i]);
+    } else {
+      // unused until retarget moves the users over, as after loadTextures
+      slot.resident = true;
+      m_residentBytes += bytes;
+      m_unusedBytes += bytes;
+    }
+    slot.bytes = bytes;
+  }
+
+  for (const auto &entry : manifest.fonts) {
+    auto it = m_fontMap.find(entry.name);
+    if (it == m_fontMap.end()) {
+      addFont(entry.name, entry.path);
+    } else if (m_fontSlots[it->second.index].path != entry.path) {
+      m_fontSlots[it->second.index].path = entry.path;
+      m_fontSlots[it->second.index].reading = {};
+    }
+  }
+  for (size_t i = 0; i < reloadedFonts.size(); i++) {
+    FontSlot &slot = m_fontSlots[reloadedFonts[i].index];
+    // the old face reads from the old buffer until the font is replaced,
+    // the new buffer moves along with its vector so the font still reads it
+    m_fonts[reloadedFonts[i].index] = fonts[i];
+    m_fontData[reloadedFonts[i].index] = std::move(fontData[i]);
+    const size_t bytes = m_fontData[reloadedFonts[i].index].size();
+    m_residentBytes = m_residentBytes - slot.bytes + bytes;
+    if (slot.users == 0) {
+      m_unusedBytes = m_unusedBytes - slot.bytes + bytes;
+    }
+    slot.bytes = bytes;
+  }
+
+  std::vector<AnimationHandle> rebuilt;
+  for (size_t i = 0; i < manifest.animations.size(); i++) {
+    const auto &entry = manifest.animations[i];
+    auto it = m_animationMap.find(entry.name);
+    if (it == m_animationMap.end()) {
+      addAnimation(entry.name, entry.texture, entry.frameCount, entry.speed);
+      continue;
+    }
+    const TextureHandle texture = animationTextures[i];
+    AnimationSlot &slot = m_animationSlots[it->second.index];
+    if (slot.texture == texture && slot.frameCount == entry.frameCount &&
+        slot.speed == entry.speed) {
+      continue;
+    }
+    retarget(it->second, texture); // resident when in use, see above
+    slot.frameCount = entry.frameCount;
+    slot.speed = entry.speed;
+    if (slot.built && m_textureSlots[texture.index].resident) {
+      buildAnimation(it->second);
+      rebuilt.push_back(it->second);
+    } else {
+      slot.built = false; // built by the next acquire
+    }
+  }
+
+  for (const auto &[animation, properties] : tileTypes) {
+    setTileProperties(animation, properties);
+  }
+
+  rebuildAnimations(changedTextures, rebuilt);
+  evictUnused();
+  return rebuilt;
+}
+
+std::vector<AnimationHandle> Assets::reloadFile(const std::string &path) {
+  std::vector<TextureHandle> changedTextures;
+  for (size_t i = 0; i < m_textureSlots.size(); i++) {
+    TextureSlot &slot = m_textureSlots[i];
+    if (slot.path != path) {
+      continue;
+    }
+    slot.decoding = {}; // a prefetch may have decoded the old content
+    if (slot.resident) {
+      reloadTexture(TextureHandle(i));
+      changedTextures.push_back(TextureHandle(i));
+    }
+  }
+  for (size_t i = 0; i < m_fontSlots.size(); i++) {
+    FontSlot &slot = m_fontSlots[i];
+    if (slot.path != path) {
+      continue;
+    }
+    slot.reading = {};
+    if (slot.resident) {
+      reloadFont(FontHandle(i));
+    }
+  }
+
+  std::vector<AnimationHandle> rebuilt;
+  rebuildAnimations(changedTextures, rebuilt);
+  return rebuilt;
+}
+
+std::vector<std::string> Assets::sourceFiles() const {
+  std::vector<std::string> files;
+  for (const auto &slot : m_textureSlots) {
+    if (!slot.path.empty()) {
+      files.push_back(slot.path);
+    }
+  }
+  for (const auto &slot : m_fontSlots) {
+    if (!slot.path.empty()) {
+      files.push_back(slot.path);
+    }
+  }
+  return files;
+}
+
+void Assets::evictUnused() {
+  // least recently used first until the unused assets fit the budget
+  while (m_unusedBytes > m_memoryBudget) {
+    TextureSlot *oldestTexture = nullptr;
+    size_t textureIndex = 0;
+    for (size_t i = 0; i < m_textureSlots.size(); i++) {
+      TextureSlot &slot = m_textureSlots[i];
+      if (slot.resident && slot.users == 0 &&
+          (!oldestTexture || slot.lastUsed < oldestTexture->lastUsed)) {
+        oldestTexture = &slot;
+        textureIndex = i;
+      }
+    }
+    FontSlot *oldestFont = nullptr;
+    size_t fontIndex = 0;
+    for (size_t i = 0; i < m_fontSlots.size(); i++) {
+      FontSlot &slot = m_fontSlots[i];
+      if (slot.resident && slot.users == 0 &&
+          (!oldestFont || slot.lastUsed < oldestFont->lastUsed)) {
+        oldestFont = &slot;
+        fontIndex = i;
+      }
+    }
+
+    if (oldestTexture != nullptr &&
+        (oldestFont == nullptr ||
+         oldestTexture->lastUsed < oldestFont->lastUsed)) {
+      // animations keep their size and sprite, the texture is reloaded into
+      // the same object when it is acquired again
+      m_textures[textureIndex] = sf::Texture();
+      oldestTexture->resident = false;
+      m_residentBytes -= oldestTexture->bytes;
+      m_unusedBytes -= oldestTexture->bytes;
+    } else if (oldestFont != nullptr) {
+      m_fonts[fontIndex] = sf::Font();
+      m_fontData[fontIndex] = std::vector<char>();
+      oldestFont->resident = false;
+      m_residentBytes -= oldestFont->bytes;
+      m_unusedBytes -= oldestFont->bytes;
+    } else {
+      break;
+    }
+  }
+}
+
+bool Assets::isResident(AnimationHandle animation) const {
+  const AnimationSlot &slot = m_animationSlots[animation.index];
+  return slot.built && m_textureSlots[slot.texture.index].resident;
+}
+
+size_t Assets::residentBytes() const { return m_residentBytes; }
+
+TextureHandle Assets::getTextureHandle(const std::string &name) const {
+  auto it = m_textureMap.find(name);
+  if (it == m_textureMap.end()) {
+    throw AssetError("Unknown texture: " + name);
+  }
+  return it->second;
+}
+
+AnimationHandle Assets::getAnimationHandle(const std::string &name) const {
+  auto it = m_animationMap.find(name);
+  if (it == m_animationMap.end()) {
+    throw AssetError("Unknown animation: " + name);
+  }
+  return it->second;
+}
+
+FontHandle Assets::getFontHandle(const std::string &name) const {
+  auto it = m_fontMap.find(name);
+  if (it == m_fontMap.end()) {
+    throw AssetError("Unknown font: " + name);
+  }
+  return it->second;
+}
+
+const sf::Texture &Assets::getTexture(TextureHandle handle) const {
+  assert(handle.index < m_textures.size());
+  assert(m_textureSlots[handle.index].resident);
+  return m_textures[handle.index];
+}
+
+const Animation &Assets::getAnimation(AnimationHandle handle) const {
+  assert(handle.index < m_animations.size());
+  assert(isResident(handle));
+  return m_animations[handle.index];
+}
+
+const sf::Font &Assets::getFont(FontHandle handle) const {
+  assert(handle.index < m_fonts.size());
+  assert(m_fontSlots[handle.index].resident);
+  return m_fonts[handle.index];
+}
+
+const TileProperties &
+Assets::getTileProperties(AnimationHandle handle) const {
+  assert(handle.index < m_tileProperties.size());
+  return m_tileProperties[handle.index];
 }
 
 const Animation &Assets::getAnimation(const std::string &name) const {
-  assert(m_animationMap.find(name) != m_animationMap.end());
-  return m_animationMap.at(name);
+  return getAnimation(getAnimationHandle(name));
 }
 
 const sf::Font &Assets::getFont(const std::string &name) const {
-  assert(m_fontMap.find(name) != m_fontMap.end());
-  return m_fontMap.at(name);
+  return getFont(getFontHandle(name));
+}
+
+AssetScope::AssetScope() = default;
+
+AssetScope::AssetScope(Assets *assets) : m_assets(assets) {}
+
+AssetScope::~AssetScope() { releaseAll(); }
+
+bool AssetScope::holds(AnimationHandle animation) const {
+  return std::find(m_animations.begin(), m_animations.end(), animation) !=
+         m_animations.end();
+}
+
+void AssetScope::require(const std::vector<AnimationHandle> &animations) {
+  assert(m_assets != nullptr);
+
+  // unique animations not held yet, plus what their tile types spawn
+  std::vector<AnimationHandle> pending(animations);
+  std::sort(pending.begin(), pending.end(),
+            [](AnimationHandle a, AnimationHandle b) {
+              return a.index < b.index;
+            });
+  pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+  std::vector<AnimationHandle> acquired;
+  while (!pending.empty()) {
+    const AnimationHandle animation = pending.back();
+    pending.pop_back();
+    if (holds(animation) ||
+        std::find(acquired.begin(), acquired.end(), animation) !=
+            acquired.end()) {
+      continue;
+    }
+    acquired.push_back(animation);
+
+    const TileProperties &properties = m_assets->getTileProperties(animation);
+    if (properties.reward.isValid()) {
+      pending.push_back(properties.reward);
+    }
+    if (properties.bumped.isValid()) {
+      pending.push_back(properties.bumped);
+    }
+  }
+
+  m_assets->acquire(acquired);
+  m_animations.insert(m_animations.end(), acquired.begin(), acquired.end());
+}
+
+AnimationHandle AssetScope::require(const std::string &animation) {
+  const AnimationHandle handle = m_assets->getAnimationHandle(animation);
+  require(std::vector<AnimationHandle>{handle});
+  return handle;
+}
+
+FontHandle AssetScope::requireFont(const std::string &font) {
+  assert(m_assets != nullptr);
+  const FontHandle handle = m_assets->getFontHandle(font);
+  if (std::find(m_fonts.begin(), m_fonts.end(), handle) == m_fonts.end()) {
+    m_assets->acquire(handle);
+    m_fonts.push_back(handle);
+  }
+  return handle;
+}
+
+void AssetScope::releaseAll() {
+  if (m_assets == nullptr) {
+    return;
+  }
+  for (const auto animation : m_animations) {
+    m_assets->release(animation);
+  }
+  for (const auto font : m_fonts) {
+    m_assets->release(font);
+  }
+  m_animations.clear();
+  m_fonts.clear();
 }
@@ -12,6 +12,12 @@ Entity::Entity(const size_t i, std::string t) : m_id(i), m_tag(std::move(t)) {
   //    );
 }
 
+void Entity::recycle(size_t id) {
+  m_id = id;
+  m_active = true;
+  m_components = ComponentTuple();
+}
+
 bool Entity::isActive() const { return m_active; }
 
 const std::string &Entity::tag() const { return m_tag; }
@@ -15,8 +15,17 @@ void EntityManager::update() {
   }
   m_entitiesToAdd.clear();
 
-  // remove dead entities from the vector of all entities
-  removeDeadEntities(m_entities);
+  // remove dead entities from the vector of all entities, pooled ones are
+  // free again once they are out of the tag vectors below as well
+  std::erase_if(m_entities, [this](const std::shared_ptr<Entity> &entity) {
+    if (entity->isActive()) {
+      return false;
+    }
+    if (entity->m_pooled) {
+      m_pools[entity->tag()].push_back(entity);
+    }
+    return true;
+  });
 
   // remove dead entities from each vector in the entity map
   // C++20 way ot iterating through [key, value] pairs in a map
@@ -40,16 +49,45 @@ void EntityManager::removeDeadEntities(EntityVec &vec) {
 }
 
 std::shared_ptr<Entity> EntityManager::addEntity(const std::string &tag) {
+  auto pool = m_pools.find(tag);
+  if (pool != m_pools.end()) {
+    if (pool->second.empty()) {
+      return nullptr;
+    }
+    auto entity = std::move(pool->second.back());
+    pool->second.pop_back();
+    entity->recycle(m_totalEntities++);
+    m_entitiesToAdd.push_back(entity);
+    return entity;
+  }
+
   auto entity = std::shared_ptr<Entity>(new Entity(m_totalEntities++, tag));
   m_entitiesToAdd.push_back(entity);
 
   return entity;
 }
 
+void EntityManager::addPool(const std::string &tag, size_t capacity) {
+  EntityVec &pool = m_pools[tag];
+  // the free list and the tag vector can hold the whole pool, so recycling
+  // never reallocates
+  pool.reserve(pool.capacity() + capacity);
+  EntityVec &alive = m_entityMap[tag];
+  alive.reserve(alive.size() + pool.capacity());
+  for (size_t i = 0; i < capacity; i++) {
+    auto entity = std::shared_ptr<Entity>(new Entity(0, tag));
+    entity->m_active = false;
+    entity->m_pooled = true;
+    pool.push_back(std::move(entity));
+  }
+}
+
 EntityVec &EntityManager::getEntities() { return m_entities; }
 
 EntityVec &EntityManager::getEntities(const std::string &tag) {
   return m_entityMap[tag];
 }
 
+EntityVec &EntityManager::getPendingEntities() { return m_entitiesToAdd; }
+
 const EntityMap &EntityManager::getEntityMap() { return m_entityMap; }
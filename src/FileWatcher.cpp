@@ -0,0 +1,80 @@
+#include "../include/FileWatcher.h"
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+
+FileWatcher::FileWatcher() : m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+
+FileWatcher::~FileWatcher() {
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+bool FileWatcher::watch(const std::string &path) {
+  if (m_fd < 0) {
+    return false;
+  }
+
+  const std::filesystem::path file(path);
+  std::string directory = file.parent_path().string();
+  if (directory.empty()) {
+    directory = ".";
+  }
+
+  auto it = m_directories.find(directory);
+  if (it == m_directories.end()) {
+    // written in place or renamed over, not created: that fires before the
+    // content is there
+    const int wd = inotify_add_watch(m_fd, directory.c_str(),
+                                     IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+      return false;
+    }
+    it = m_directories.emplace(directory, wd).first;
+  }
+  m_files[{it->second, file.filename().string()}] = path;
+  return true;
+}
+
+std::vector<std::string> FileWatcher::poll() {
+  std::vector<std::string> changed;
+  if (m_fd < 0) {
+    return changed;
+  }
+
+  alignas(inotify_event) char buffer[4096];
+  ssize_t length = 0;
+  while ((length = read(m_fd, buffer, sizeof(buffer))) > 0) {
+    for (ssize_t offset = 0; offset < length;) {
+      const auto *event =
+          reinterpret_cast<const inotify_event *>(buffer + offset);
+      offset += ssize_t(sizeof(inotify_event) + event->len);
+      if (event->len == 0) {
+        continue;
+      }
+      auto file = m_files.find({event->wd, event->name});
+      if (file != m_files.end() &&
+          std::find(changed.begin(), changed.end(), file->second) ==
+              changed.end()) {
+        changed.push_back(file->second);
+      }
+    }
+  }
+  return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::watch(const std::string &path) { return false; }
+
+std::vector<std::string> FileWatcher::poll() { return {}; }
+
+#endif
@@ -0,0 +1,68 @@
+#include "../include/FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t blockSize) : m_blockSize(blockSize) {}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+  while (true) {
+    if (m_current < m_blocks.size()) {
+      Block &block = m_blocks[m_current];
+      const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+      const uintptr_t aligned =
+          (base + m_offset + alignment - 1) & ~uintptr_t(alignment - 1);
+      const size_t end = size_t(aligned - base) + size;
+      if (end <= block.size) {
+        m_used += end - m_offset;
+        m_offset = end;
+        return reinterpret_cast<void *>(aligned);
+      }
+      if (m_current + 1 < m_blocks.size()) {
+        m_current++;
+        m_offset = 0;
+        continue;
+      }
+    }
+
+    // the first frames grow the arena, reset() merges the blocks later
+    Block block;
+    block.size = std::max(m_blockSize, size + alignment);
+    block.data = std::make_unique<std::byte[]>(block.size);
+    m_blocks.push_back(std::move(block));
+    m_current = m_blocks.size() - 1;
+    m_offset = 0;
+  }
+}
+
+void FrameArena::reset() {
+  m_peak = std::max(m_peak, m_used);
+  if (m_blocks.size() > 1) {
+    // one block that fits the busiest frame so far
+    size_t total = 0;
+    for (const auto &block : m_blocks) {
+      total += block.size;
+    }
+    m_blocks.clear();
+    Block block;
+    block.size = std::max(total, m_peak);
+    block.data = std::make_unique<std::byte[]>(block.size);
+    m_blocks.push_back(std::move(block));
+  }
+  m_current = 0;
+  m_offset = 0;
+  m_used = 0;
+  for (auto &arena : m_subArenas) {
+    arena->reset();
+  }
+}
+
+FrameArena &FrameArena::sub(size_t index) {
+  while (m_subArenas.size() <= index) {
+    m_subArenas.push_back(std::make_unique<FrameArena>(m_blockSize));
+  }
+  return *m_subArenas[index];
+}
+
+size_t FrameArena::used() const { return m_used; }
+
+size_t FrameArena::peak() const { return m_peak; }
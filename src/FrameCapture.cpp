@@ -0,0 +1,182 @@
+#include "../include/FrameCapture.h"
+#include "../include/Profiler.h"
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// local time down to the millisecond, sortable and safe in a file name
+std::string timestamp() {
+  const auto now = std::chrono::system_clock::now();
+  const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+  const auto milliseconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          now.time_since_epoch()) %
+      1000;
+  std::ostringstream text;
+  text << std::put_time(std::localtime(&seconds), "%Y%m%d-%H%M%S") << "-"
+       << std::setw(3) << std::setfill('0') << milliseconds.count();
+  return text.str();
+}
+
+} // namespace
+
+FrameCapture::FrameCapture() : m_writer(&FrameCapture::writerLoop, this) {}
+
+FrameCapture::~FrameCapture() {
+  readBack(true);
+  reap(true);
+  setContinuous(0);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wakeUp.notify_one();
+  m_writer.join();
+}
+
+void FrameCapture::screenshot() { m_screenshot = true; }
+
+void FrameCapture::setContinuous(size_t interval) {
+  if (interval == m_interval) {
+    return;
+  }
+  if (m_interval != 0) {
+    std::cout << "Captured " << m_captured << " frames to "
+              << m_captureDirectory << ", dropped " << m_dropped
+              << std::endl;
+  }
+  m_interval = interval;
+  m_captured = 0;
+  m_dropped = 0;
+  if (m_interval == 0) {
+    return;
+  }
+
+  m_captureDirectory = "capture-" + timestamp();
+  std::error_code error;
+  std::filesystem::create_directories(m_captureDirectory, error);
+  if (error) {
+    std::cerr << "Could not create " << m_captureDirectory << ": "
+              << error.message() << std::endl;
+    m_interval = 0;
+    return;
+  }
+  std::cout << "Capturing every " << m_interval << " frames to "
+            << m_captureDirectory << std::endl;
+}
+
+size_t FrameCapture::continuousInterval() const { return m_interval; }
+
+void FrameCapture::capture(const sf::RenderWindow &window) {
+  PROFILE_SCOPE("FrameCapture");
+  m_frame++;
+  readBack(false);
+  reap(false);
+
+  if (m_screenshot) {
+    m_screenshot = false;
+    stage(window, "screenshot-" + timestamp() + ".png");
+  }
+  if (m_interval != 0 && m_frame % m_interval == 0) {
+    std::ostringstream path;
+    path << m_captureDirectory << "/frame-" << std::setw(8)
+         << std::setfill('0') << m_frame << ".png";
+    m_captured += stage(window, path.str());
+  }
+}
+
+bool FrameCapture::stage(const sf::RenderWindow &window, std::string path) {
+  Staging *free = nullptr;
+  for (auto &staging : m_staging) {
+    if (!staging.used) {
+      free = &staging;
+      break;
+    }
+  }
+  // the encoder falling behind drops frames rather than the frame rate
+  size_t pending = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pending = m_writes.size();
+  }
+  if (free == nullptr || pending >= kMaxPendingWrites) {
+    m_dropped++;
+    return false;
+  }
+
+  const sf::Vector2u size = window.getSize();
+  if (free->texture.getSize() != size) {
+    free->texture.create(size.x, size.y);
+  }
+  // a copy on the GPU, queued behind the frame's drawing
+  free->texture.update(window);
+  free->used = true;
+  free->frame = m_frame;
+  free->path = std::move(path);
+  return true;
+}
+
+void FrameCapture::readBack(bool all) {
+  for (auto &staging : m_staging) {
+    if (!staging.used ||
+        (!all && m_frame - staging.frame < kStagingFrames - 1)) {
+      continue;
+    }
+    staging.used = false;
+    Write write{staging.texture.copyToImage(), std::move(staging.path)};
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_writes.push_back(std::move(write));
+    }
+    m_wakeUp.notify_one();
+  }
+}
+
+void FrameCapture::reap(bool wait) {
+  std::vector<Write> finished;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (wait) {
+      m_drained.wait(lock, [this] { return m_writes.empty(); });
+    }
+    std::swap(finished, m_finished);
+  }
+  for (const auto &write : finished) {
+    // continuous captures are summed up when they stop
+    if (!write.saved) {
+      std::cerr << "Could not save " << write.path << std::endl;
+    } else if (write.path.rfind("screenshot-", 0) == 0) {
+      std::cout << "Screenshot saved to " << write.path << std::endl;
+    }
+  }
+}
+
+void FrameCapture::writerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_wakeUp.wait(lock, [this] { return m_stopping || !m_writes.empty(); });
+    if (m_writes.empty()) {
+      return;
+    }
+
+    // encoded without the lock, the write stays counted as pending
+    Write &write = m_writes.front();
+    lock.unlock();
+    {
+      PROFILE_SCOPE("FrameCapture::write");
+      write.saved = write.image.saveToFile(write.path);
+    }
+    write.image = sf::Image();
+    lock.lock();
+    m_finished.push_back(std::move(m_writes.front()));
+    m_writes.pop_front();
+    if (m_writes.empty()) {
+      m_drained.notify_all();
+    }
+  }
+}
@@ -0,0 +1,169 @@
+#include "../include/FramePacer.h"
+#include <SFML/System/Sleep.hpp>
+#include <algorithm>
+#include <thread>
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t kMaxDivisor = 4;
+constexpr size_t kAdaptFrames = 120;     // frames between two decisions
+constexpr double kSlowDownMissed = 0.05; // of them missed to slow down
+constexpr double kSpeedUpLoad = 0.75;    // of the faster period to speed up
+constexpr auto kMinSpinMargin = microseconds(200);
+constexpr auto kMaxSpinMargin = milliseconds(4);
+constexpr auto kIdleSlice = milliseconds(1);
+
+double toMs(FramePacer::Clock::duration elapsed) {
+  return duration_cast<duration<double, std::milli>>(elapsed).count();
+}
+
+} // namespace
+
+FramePacer::FramePacer() = default;
+
+void FramePacer::setTarget(double hz) {
+  m_maxHz = std::max(hz, 0.0);
+  m_divisor = 1;
+  m_adaptFrames = 0;
+  m_adaptMissed = 0;
+  m_adaptWorstWork = {};
+  m_deadline = m_frameStart;
+}
+
+void FramePacer::setVSync(bool vsync) { m_vsync = vsync; }
+
+void FramePacer::setIdleTask(std::function<void()> task) {
+  m_idleTask = std::move(task);
+}
+
+FramePacer::Clock::duration FramePacer::period() const {
+  return duration_cast<Clock::duration>(
+      duration<double>(double(m_divisor) / m_maxHz));
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline) {
+  const Clock::time_point wakeUp = deadline - m_spinMargin;
+  while (true) {
+    if (m_idleTask) {
+      m_idleTask();
+    }
+    const Clock::time_point before = Clock::now();
+    if (before >= wakeUp) {
+      break;
+    }
+
+    // sf::sleep raises the timer resolution where the OS needs it to
+    const auto slice = std::min<Clock::duration>(wakeUp - before, kIdleSlice);
+    sf::sleep(sf::microseconds(
+        sf::Int64(duration_cast<microseconds>(slice).count())));
+
+    // the margin jumps to a late wake up and slowly comes back down
+    const Clock::duration late = Clock::now() - (before + slice);
+    if (late > m_spinMargin) {
+      m_spinMargin = late;
+    } else {
+      m_spinMargin -= (m_spinMargin - late) / 64;
+    }
+    m_spinMargin = std::clamp<Clock::duration>(m_spinMargin, kMinSpinMargin,
+                                               kMaxSpinMargin);
+  }
+  while (Clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+void FramePacer::wait() {
+  const Clock::duration work = Clock::now() - m_frameStart;
+  bool missed = false;
+  if (m_maxHz > 0 && !m_vsync) {
+    m_deadline += period();
+    missed = Clock::now() > m_deadline;
+    if (missed) {
+      // late frames are not caught up on, the next one gets a full period
+      m_deadline = Clock::now();
+    } else {
+      sleepUntil(m_deadline);
+    }
+    adapt(work, missed);
+  }
+
+  const Clock::time_point now = Clock::now();
+  record(toMs(now - m_frameStart), missed);
+  m_frameStart = now;
+}
+
+void FramePacer::adapt(Clock::duration work, bool missed) {
+  m_adaptFrames++;
+  m_adaptMissed += missed;
+  m_adaptWorstWork = std::max(m_adaptWorstWork, work);
+  if (m_adaptFrames < kAdaptFrames) {
+    return;
+  }
+
+  if (double(m_adaptMissed) > kSlowDownMissed * double(m_adaptFrames) &&
+      m_divisor < kMaxDivisor) {
+    m_divisor++;
+  } else if (m_divisor > 1) {
+    const Clock::duration faster = duration_cast<Clock::duration>(
+        duration<double>(double(m_divisor - 1) / m_maxHz));
+    if (m_adaptWorstWork < faster * kSpeedUpLoad) {
+      m_divisor--;
+    }
+  }
+  m_adaptFrames = 0;
+  m_adaptMissed = 0;
+  m_adaptWorstWork = {};
+}
+
+void FramePacer::record(double frameMs, bool missed) {
+  auto bucket = [](double ms) {
+    return std::min(size_t(ms / kBucketMs), kBuckets - 1);
+  };
+  if (m_count == kHistoryFrames) {
+    // the oldest frame leaves the window
+    m_buckets[bucket(m_frameMs[m_next])]--;
+    m_totalMs -= m_frameMs[m_next];
+    m_totalMissed -= m_missed[m_next];
+  } else {
+    m_count++;
+  }
+  m_frameMs[m_next] = float(frameMs);
+  m_missed[m_next] = missed;
+  m_buckets[bucket(frameMs)]++;
+  m_totalMs += float(frameMs);
+  m_totalMissed += missed;
+  m_next = (m_next + 1) % kHistoryFrames;
+}
+
+size_t FramePacer::ticksPerFrame() const { return m_divisor; }
+
+FramePacer::Stats FramePacer::stats() const {
+  Stats stats;
+  stats.frames = m_count;
+  stats.missed = m_totalMissed;
+  stats.targetHz = m_maxHz > 0 && !m_vsync ? m_maxHz / double(m_divisor) : 0;
+  if (m_count == 0) {
+    return stats;
+  }
+  stats.averageMs = m_totalMs / double(m_count);
+  stats.maxMs = *std::max_element(m_frameMs.begin(),
+                                  m_frameMs.begin() + ptrdiff_t(m_count));
+
+  // the upper edge of the bucket the percentile falls in
+  auto percentile = [this](double p) {
+    const auto rank = size_t(p * double(m_count - 1));
+    size_t seen = 0;
+    for (size_t i = 0; i < kBuckets; i++) {
+      seen += m_buckets[i];
+      if (seen > rank) {
+        return double(i + 1) * kBucketMs;
+      }
+    }
+    return double(kBuckets) * kBucketMs;
+  };
+  stats.p50Ms = std::min(percentile(0.5), stats.maxMs);
+  stats.p99Ms = std::min(percentile(0.99), stats.maxMs);
+  return stats;
+}
@@ -1,25 +1,77 @@
+#include <algorithm>
 #include <iostream>
 #include <utility>
 
 #include "../include/Assets.h"
 #include "../include/GameEngine.h"
+#include "../include/Profiler.h"
+#include "../include/Scene_Loading.h"
 #include "../include/Scene_Menu.h"
 #include "../include/Scene_Play.h"
 #include "SFML/Window/Event.hpp"
 
-GameEngine::GameEngine(const std::string &path) { init(path); }
+GameEngine::GameEngine(const std::string &path, const GameOptions &options) {
+  init(path, options);
+}
 
-void GameEngine::init(const std::string &path) {
-  m_assets.loadFromFile(path);
+void GameEngine::init(const std::string &path, const GameOptions &options) {
+  if (!options.record.empty()) {
+    m_recorder.open(options.record);
+  }
+  if (!options.replay.empty()) {
+    m_replay.open(options.replay);
+    m_replaying = true;
+  }
+  m_deterministic = m_recorder.isOpen() || m_replaying;
+  m_headless = options.headless;
+  if (options.allocationTest) {
+    m_allocationTest = std::make_unique<AllocationTest>();
+  }
 
+  // the window opens and shows a frame before anything is loaded, the rest
+  // happens behind Scene_Loading; headless it only provides the GL context
   m_window.create(sf::VideoMode(1280, 768), "Definitely Not Mario");
-  m_window.setFramerateLimit(m_frameLimit);
+  if (m_headless) {
+    m_window.setVisible(false);
+  } else {
+    // the allocation test draws but has no reason to wait
+    m_window.setVerticalSyncEnabled(options.vsync && !m_allocationTest);
+    m_framePacer.setVSync(options.vsync);
+    m_framePacer.setTarget(m_allocationTest ? 0 : m_frameLimit);
+    m_framePacer.setIdleTask([this]() { m_inputQueue.pump(m_window); });
+    if (options.captureInterval != 0) {
+      m_captureInterval = options.captureInterval;
+      m_frameCapture.setContinuous(m_captureInterval);
+    }
+    m_window.clear(sf::Color(100, 100, 255));
+    m_window.display();
+  }
 
-  changeScene("MENU", std::make_shared<Scene_Menu>(this));
+  m_assets.setThreadPool(&m_threadPool);
+  m_assets.setMemoryBudget(options.assetMemoryBudget);
+
+  pushScene("LOADING", std::make_shared<Scene_Loading>(this, path));
+  applySceneChanges();
+}
+
+void GameEngine::loadAssets(const std::string &path,
+                            const AssetManifest &manifest) {
+  m_assetsPath = path;
+  if (Assets::isBundle(path)) {
+    // a bundle is packed offline, only the text manifest is reloaded live
+    m_assets.loadFromBundle(path);
+    return;
+  }
+
+  m_assets.load(manifest);
+  watchFile(path);
+  for (const auto &file : m_assets.sourceFiles()) {
+    watchFile(file);
+  }
 }
 
-std::shared_ptr<Scene> GameEngine::currentScene() {
-  return m_sceneMap[m_currentScene];
+const std::shared_ptr<Scene> &GameEngine::currentScene() const {
+  return m_sceneStack.back().scene;
 }
 
 bool GameEngine::isRunning() {
@@ -30,56 +82,304 @@ sf::RenderWindow &GameEngine::window() { return m_window; }
 
 void GameEngine::run() {
   while (isRunning()) {
-    sUserInput();
-    update();
-    m_window.display();
+    {
+      PROFILE_SCOPE("Frame");
+      m_frameArena.reset();
+      {
+        PROFILE_SCOPE("HotReload");
+        sHotReload();
+      }
+      // at a fraction of the frame limit the pacer asks for that many ticks
+      // per frame, so the fixed step simulation keeps its speed; only the
+      // last one is drawn
+      const size_t ticks = m_framePacer.ticksPerFrame();
+      for (size_t tick = 0; tick < ticks && isRunning(); tick++) {
+        if (tick > 0) {
+          applySceneChanges();
+        }
+        {
+          PROFILE_SCOPE("Input");
+          sUserInput();
+        }
+        m_rendering = !m_headless && tick + 1 == ticks;
+        update();
+      }
+      if (!m_headless) {
+        if (!m_sceneStack.empty()) {
+          m_profilerOverlay.draw(m_window, *currentScene());
+        }
+        m_frameCapture.capture(m_window);
+        PROFILE_SCOPE("Present");
+        m_window.display();
+        m_inputQueue.presented();
+      }
+      applySceneChanges();
+    }
+    // outside the frame's zone, which is then the time the frame needed
+    m_framePacer.wait();
   }
 }
 
 void GameEngine::sUserInput() {
-  sf::Event event{};
-
-  while (m_window.pollEvent(event)) {
+  m_inputQueue.pump(m_window);
+  for (const auto &timed : m_inputQueue.latch()) {
+    const sf::Event &event = timed.event;
     if (event.type == sf::Event::Closed) {
       quit();
     }
 
     if (event.type == sf::Event::KeyPressed) {
-      if (event.key.code == sf::Keyboard::X) {
-        std::cout << "Save screenshot to " << "test.png" << std::endl;
-        sf::Texture texture;
-        texture.create(m_window.getSize().x, m_window.getSize().y);
-        texture.update(m_window);
-        if (texture.copyToImage().saveToFile("test.png")) {
-          std::cout << "Screenshot saved to " << "test.png" << std::endl;
+      if (event.key.code == sf::Keyboard::F3) {
+        m_profilerOverlay.toggle();
+      }
+      if (event.key.code == sf::Keyboard::F4) {
+        const Profiler &profiler = Profiler::instance();
+        if (profiler.writeCsv("profile.csv") &&
+            profiler.writeTrace("profile.json")) {
+          std::cout << "Profile saved to profile.csv and profile.json"
+                    << std::endl;
         }
       }
+      if (event.key.code == sf::Keyboard::X) {
+        m_frameCapture.screenshot();
+      }
+      if (event.key.code == sf::Keyboard::F5) {
+        m_frameCapture.setContinuous(
+            m_frameCapture.continuousInterval() == 0 ? m_captureInterval : 0);
+      }
     }
 
-    if (event.type == sf::Event::KeyPressed ||
-        event.type == sf::Event::KeyReleased) {
+    // while replaying the recording is the only input
+    if (!m_replaying && (event.type == sf::Event::KeyPressed ||
+                         event.type == sf::Event::KeyReleased)) {
       // if the current scene does not have an action associated with this key,
       // skip the event
-      if (currentScene()->getActionMap().find(event.key.code) ==
-          currentScene()->getActionMap().end()) {
+      Scene *scene = currentScene().get();
+      const ActionName actionName = scene->actionFor(event.key.code);
+      if (actionName == ActionName::None) {
         continue;
       }
 
       // determine start or end action by whether it was key press or release
-      const std::string actionType =
-          (event.type == sf::Event::KeyPressed) ? "START" : "END";
-      // look up the action and send the action to the scene
-      currentScene()->doAction(Action(
-          currentScene()->getActionMap().at(event.key.code), actionType));
+      const ActionType actionType = (event.type == sf::Event::KeyPressed)
+                                        ? ActionType::Start
+                                        : ActionType::End;
+      // send the action to the scene
+      sendAction(*scene, Action(actionName, actionType));
+      m_inputQueue.applied(timed);
     }
   }
 }
 
-void GameEngine::changeScene(const std::string &sceneName,
-                             std::shared_ptr<Scene> scene,
-                             bool endCurrentScene) {
-  m_currentScene = sceneName;
-  m_sceneMap[sceneName] = scene;
+void GameEngine::sendAction(Scene &scene, const Action &action) {
+  if (m_recorder.isOpen()) {
+    m_recorder.action(m_sceneSerial, m_sceneTick, action);
+  }
+  scene.doAction(action);
+}
+
+void GameEngine::sReplay(Scene &scene, bool afterUpdate) {
+  if (!afterUpdate) {
+    if (m_replaying) {
+      for (const Action &action :
+           m_replay.actions(m_sceneSerial, m_sceneTick)) {
+        sendAction(scene, action);
+      }
+    }
+    return;
+  }
+
+  if (!m_deterministic) {
+    return;
+  }
+  PROFILE_SCOPE("Replay::checksum");
+  const uint32_t checksum = scene.checksum();
+  if (m_recorder.isOpen()) {
+    m_recorder.checksum(m_sceneSerial, m_sceneTick, checksum);
+  }
+  uint32_t expected = 0;
+  if (m_replaying && !m_replayDiverged &&
+      !m_replay.verify(m_sceneSerial, m_sceneTick, checksum, expected)) {
+    // only the first divergence is reported, everything after follows it
+    m_replayDiverged = true;
+    std::cerr << "Replay diverged in scene " << m_sceneSerial << " at tick "
+              << m_sceneTick << ": checksum " << std::hex << checksum
+              << ", recorded " << expected << std::dec << std::endl;
+    if (m_headless) {
+      quit();
+    }
+  }
+  if (m_replaying && m_replay.finished()) {
+    m_replaying = false;
+    std::cout << "Replay finished"
+              << (m_replayDiverged ? " with a divergence" : ", no divergence")
+              << std::endl;
+    if (m_headless) {
+      quit();
+    }
+  }
+}
+
+void GameEngine::sceneChanged() {
+  m_sceneSerial++;
+  m_sceneTick = 0;
+}
+
+void GameEngine::sHotReload() {
+  for (const auto &path : m_fileWatcher.poll()) {
+    // a file caught half way through saving is reported and the old
+    // content kept, the next save reloads it
+    try {
+      PROFILE_SCOPE("HotReload::file");
+      std::vector<AnimationHandle> rebuilt;
+      if (path == m_assetsPath) {
+        rebuilt = m_assets.reloadManifest(path);
+        for (const auto &file : m_assets.sourceFiles()) {
+          watchFile(file);
+        }
+      } else {
+        rebuilt = m_assets.reloadFile(path);
+      }
+      // suspended and cached scenes hold copies as well, tile types can
+      // change without any animation being rebuilt. The scenes are taken
+      // first, a scene may drop others from the cache when it is told, and
+      // those are torn down there and then and skipped here.
+      std::vector<std::weak_ptr<Scene>> scenes;
+      scenes.reserve(m_sceneStack.size() + m_sceneCache.size());
+      for (const auto *entries : {&m_sceneStack, &m_sceneCache}) {
+        for (const auto &entry : *entries) {
+          scenes.push_back(entry.scene);
+        }
+      }
+      for (const auto &weakScene : scenes) {
+        const std::shared_ptr<Scene> scene = weakScene.lock();
+        if (!scene) {
+          continue;
+        }
+        if (!rebuilt.empty() || path == m_assetsPath) {
+          scene->onAssetsReloaded(rebuilt);
+        }
+        scene->onFileChanged(path);
+      }
+      std::cout << "Reloaded " << path << std::endl;
+    } catch (const std::runtime_error &e) {
+      std::cerr << "Could not reload " << path << ": " << e.what()
+                << std::endl;
+    }
+  }
+}
+
+void GameEngine::watchFile(const std::string &path) {
+  m_fileWatcher.watch(path);
+}
+
+void GameEngine::pushScene(const std::string &name,
+                           std::shared_ptr<Scene> scene) {
+  m_sceneChanges.emplace_back([this, name, scene = std::move(scene)]() {
+    m_sceneStack.push_back({name, scene});
+    sceneChanged();
+  });
+}
+
+void GameEngine::popScene() {
+  m_sceneChanges.emplace_back([this]() {
+    if (m_sceneStack.empty()) {
+      return;
+    }
+    SceneEntry finished = std::move(m_sceneStack.back());
+    m_sceneStack.pop_back();
+    retire(std::move(finished));
+    sceneChanged();
+    if (m_sceneStack.empty()) {
+      quit();
+    } else {
+      currentScene()->onResume();
+    }
+  });
+}
+
+void GameEngine::replaceScene(const std::string &name,
+                              std::shared_ptr<Scene> scene) {
+  m_sceneChanges.emplace_back([this, name, scene = std::move(scene)]() {
+    if (!m_sceneStack.empty()) {
+      SceneEntry finished = std::move(m_sceneStack.back());
+      m_sceneStack.pop_back();
+      retire(std::move(finished));
+    }
+    m_sceneStack.push_back({name, scene});
+    sceneChanged();
+  });
+}
+
+std::shared_ptr<Scene> GameEngine::takeCachedScene(const std::string &name) {
+  auto it = std::find_if(
+      m_sceneCache.begin(), m_sceneCache.end(),
+      [&name](const SceneEntry &entry) { return entry.name == name; });
+  if (it == m_sceneCache.end()) {
+    return nullptr;
+  }
+  std::shared_ptr<Scene> scene = std::move(it->scene);
+  m_sceneCache.erase(it);
+  scene->reset();
+  return scene;
+}
+
+bool GameEngine::hasCachedScene(const std::string &name) const {
+  return std::any_of(
+      m_sceneCache.begin(), m_sceneCache.end(),
+      [&name](const SceneEntry &entry) { return entry.name == name; });
+}
+
+void GameEngine::dropCachedScene(const std::string &name) {
+  auto it = std::find_if(
+      m_sceneCache.begin(), m_sceneCache.end(),
+      [&name](const SceneEntry &entry) { return entry.name == name; });
+  if (it == m_sceneCache.end()) {
+    return;
+  }
+  SceneEntry stale = std::move(*it);
+  m_sceneCache.erase(it);
+  tearDown(std::move(stale));
+}
+
+void GameEngine::applySceneChanges() {
+  // a change may queue further changes, they are applied in the same pass
+  for (size_t i = 0; i < m_sceneChanges.size(); i++) {
+    auto change = std::move(m_sceneChanges[i]);
+    change();
+  }
+  m_sceneChanges.clear();
+}
+
+void GameEngine::retire(SceneEntry entry) {
+  if (!entry.scene->isReusable() || m_sceneCacheSize == 0) {
+    tearDown(std::move(entry));
+    return;
+  }
+
+  // one cached scene per name, the most recently finished one
+  auto previous = std::find_if(
+      m_sceneCache.begin(), m_sceneCache.end(),
+      [&entry](const SceneEntry &cached) { return cached.name == entry.name; });
+  if (previous != m_sceneCache.end()) {
+    SceneEntry stale = std::move(*previous);
+    m_sceneCache.erase(previous);
+    tearDown(std::move(stale));
+  }
+  m_sceneCache.push_back(std::move(entry));
+
+  while (m_sceneCache.size() > m_sceneCacheSize) {
+    SceneEntry oldest = std::move(m_sceneCache.front());
+    m_sceneCache.erase(m_sceneCache.begin());
+    tearDown(std::move(oldest));
+  }
+}
+
+void GameEngine::tearDown(SceneEntry entry) {
+  // scenes release their entities and asset references here and not at
+  // some later point, so the cost shows up where it is paid
+  PROFILE_SCOPE("TearDown");
+  entry.scene.reset();
 }
 
 void GameEngine::quit() {
@@ -87,6 +387,42 @@ void GameEngine::quit() {
   m_window.close();
 }
 
-void GameEngine::update() { currentScene()->update(); }
+void GameEngine::update() {
+  PROFILE_SCOPE("Update");
+  if (m_sceneStack.empty()) {
+    return;
+  }
+  // scene changes wait for the end of the frame, the scene stays current
+  Scene &scene = *currentScene();
+  if (m_allocationTest) {
+    const std::string &name = m_sceneStack.back().name;
+    for (const Action &action : m_allocationTest->update(name, m_sceneTick)) {
+      sendAction(scene, action);
+    }
+    if (m_allocationTest->finished()) {
+      quit();
+    }
+  }
+  sReplay(scene, false);
+  scene.update();
+  sReplay(scene, true);
+  m_sceneTick++;
+}
 
 const Assets &GameEngine::assets() const { return m_assets; }
+
+Assets &GameEngine::assets() { return m_assets; }
+
+ThreadPool &GameEngine::threadPool() { return m_threadPool; }
+
+FrameArena &GameEngine::frameArena() { return m_frameArena; }
+
+bool GameEngine::isHeadless() const { return m_headless; }
+
+bool GameEngine::isRendering() const { return m_rendering; }
+
+bool GameEngine::isDeterministic() const { return m_deterministic; }
+
+bool GameEngine::failed() const {
+  return m_replayDiverged || (m_allocationTest && m_allocationTest->failed());
+}
@@ -0,0 +1,56 @@
+#include "../include/InputQueue.h"
+#include <algorithm>
+
+InputQueue::InputQueue() {
+  // a frame's worth of events never reallocates
+  m_queued.reserve(64);
+  m_latched.reserve(64);
+}
+
+void InputQueue::pump(sf::RenderWindow &window) {
+  TimedEvent timed{};
+  while (window.pollEvent(timed.event)) {
+    timed.time = Clock::now();
+    m_queued.push_back(timed);
+  }
+}
+
+const std::vector<InputQueue::TimedEvent> &InputQueue::latch() {
+  m_latched.clear();
+  std::swap(m_latched, m_queued);
+  return m_latched;
+}
+
+void InputQueue::applied(const TimedEvent &event) {
+  if (!m_applied || event.time < m_oldestApplied) {
+    m_oldestApplied = event.time;
+  }
+  m_applied = true;
+}
+
+void InputQueue::presented() {
+  if (!m_applied) {
+    return;
+  }
+  m_applied = false;
+  const auto latency = Clock::now() - m_oldestApplied;
+  m_latencyMs[m_next] =
+      std::chrono::duration<float, std::milli>(latency).count();
+  m_next = (m_next + 1) % kLatencySamples;
+  m_count = std::min(m_count + 1, kLatencySamples);
+}
+
+InputQueue::LatencyStats InputQueue::latency() const {
+  LatencyStats stats;
+  stats.samples = m_count;
+  if (m_count == 0) {
+    return stats;
+  }
+  for (size_t i = 0; i < m_count; i++) {
+    stats.averageMs += m_latencyMs[i];
+    stats.maxMs = std::max(stats.maxMs, double(m_latencyMs[i]));
+  }
+  stats.averageMs /= double(m_count);
+  stats.lastMs = m_latencyMs[(m_next + kLatencySamples - 1) % kLatencySamples];
+  return stats;
+}
@@ -0,0 +1,273 @@
+#include "../include/Level.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+using namespace LevelFormat;
+
+static uint32_t chunkOf(const EntityRecord &record) {
+  return uint32_t(std::max(0.0f, std::floor(record.gridX / kChunkColumns)));
+}
+
+LevelData::LevelData() = default;
+
+uint16_t LevelData::internAsset(const std::string &name) {
+  for (size_t i = 0; i < assets.size(); i++) {
+    if (assets[i] == name) {
+      return uint16_t(i);
+    }
+  }
+  if (assets.size() > UINT16_MAX) {
+    throw LevelError("Too many different animations in level");
+  }
+  assets.push_back(name);
+  return uint16_t(assets.size() - 1);
+}
+
+void LevelData::buildChunks() {
+  std::stable_sort(entities.begin(), entities.end(),
+                   [](const EntityRecord &a, const EntityRecord &b) {
+                     return chunkOf(a) < chunkOf(b);
+                   });
+
+  chunks.clear();
+  for (size_t i = 0; i < entities.size(); i++) {
+    const uint32_t chunk = chunkOf(entities[i]);
+    if (chunk >= chunks.size()) {
+      chunks.resize(chunk + 1, ChunkRecord{uint32_t(i), 0});
+    }
+    chunks[chunk].entityCount++;
+  }
+}
+
+void LevelData::loadFromText(const std::string &path) {
+  std::ifstream fileInput(path);
+  if (!fileInput.is_open()) {
+    throw LevelError("Could not open config file: " + path);
+  }
+
+  std::string configName;
+  std::string entityName;
+  while (fileInput >> configName) {
+    if (configName == "Tile" || configName == "Dec") {
+      EntityRecord record;
+      fileInput >> entityName >> record.gridX >> record.gridY;
+      record.type = configName == "Tile" ? Tile : Dec;
+      record.asset = internAsset(entityName);
+      entities.push_back(record);
+    } else if (configName == "Player") {
+      fileInput >> player.X >> player.Y >> player.CX >> player.CY >>
+          player.SPEED >> player.JUMP >> player.MAX_SPEED >> player.GRAVITY >>
+          player.WEAPON;
+    } else {
+      throw LevelError("Unknown level entry " + configName + " in " + path);
+    }
+
+    if (!fileInput) {
+      throw LevelError("Malformed " + configName + " line in " + path);
+    }
+  }
+
+  buildChunks();
+}
+
+void LevelData::writeText(const std::string &path) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file) {
+    throw LevelError("Could not write level: " + path);
+  }
+  // enough digits that columns past 100k read back exactly
+  file << std::setprecision(std::numeric_limits<float>::max_digits10);
+  for (const auto &record : entities) {
+    file << (record.type == Tile ? "Tile " : "Dec  ") << assets[record.asset]
+         << " " << record.gridX << " " << record.gridY << "\n";
+  }
+  file << "Player " << player.X << " " << player.Y << " " << player.CX << " "
+       << player.CY << " " << player.SPEED << " " << player.JUMP << " "
+       << player.MAX_SPEED << " " << player.GRAVITY << " " << player.WEAPON
+       << "\n";
+  if (!file) {
+    throw LevelError("Could not write level: " + path);
+  }
+}
+
+void LevelData::writeBinary(const std::string &path) const {
+  size_t chunked = 0;
+  for (const auto &chunk : chunks) {
+    chunked += chunk.entityCount;
+  }
+  if (chunked != entities.size()) {
+    throw LevelError("Level chunks are out of date, call buildChunks()");
+  }
+
+  std::vector<std::string> table = assets;
+  uint32_t weapon = 0;
+  for (weapon = 0; weapon < table.size(); weapon++) {
+    if (table[weapon] == player.WEAPON) {
+      break;
+    }
+  }
+  if (weapon == table.size()) {
+    table.push_back(player.WEAPON);
+  }
+
+  std::vector<uint32_t> names;
+  std::vector<char> strings;
+  for (const auto &name : table) {
+    names.push_back(uint32_t(strings.size()));
+    strings.insert(strings.end(), name.begin(), name.end());
+    strings.push_back('\0');
+  }
+
+  Header header;
+  header.assetCount = uint32_t(table.size());
+  header.entityCount = uint32_t(entities.size());
+  header.assetsOffset = sizeof(Header);
+  header.chunkCount = uint32_t(chunks.size());
+  header.chunksOffset =
+      header.assetsOffset + header.assetCount * sizeof(uint32_t);
+  header.entitiesOffset =
+      header.chunksOffset + header.chunkCount * sizeof(ChunkRecord);
+  header.stringsOffset = uint32_t(header.entitiesOffset +
+                                  entities.size() * sizeof(EntityRecord));
+  header.stringsSize = uint32_t(strings.size());
+  header.playerX = player.X;
+  header.playerY = player.Y;
+  header.playerCX = player.CX;
+  header.playerCY = player.CY;
+  header.playerSpeed = player.SPEED;
+  header.playerJump = player.JUMP;
+  header.playerMaxSpeed = player.MAX_SPEED;
+  header.playerGravity = player.GRAVITY;
+  header.playerWeapon = weapon;
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw LevelError("Could not write level: " + path);
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(names.data()),
+             std::streamsize(names.size() * sizeof(uint32_t)));
+  file.write(reinterpret_cast<const char *>(chunks.data()),
+             std::streamsize(chunks.size() * sizeof(ChunkRecord)));
+  file.write(reinterpret_cast<const char *>(entities.data()),
+             std::streamsize(entities.size() * sizeof(EntityRecord)));
+  file.write(strings.data(), std::streamsize(strings.size()));
+  if (!file) {
+    throw LevelError("Could not write level: " + path);
+  }
+}
+
+CompiledLevel::CompiledLevel() = default;
+
+void CompiledLevel::open(const std::string &path) {
+  m_header = nullptr;
+  if (!m_file.open(path)) {
+    throw LevelError("Could not map level: " + path);
+  }
+
+  const size_t size = m_file.size();
+  auto inside = [size](size_t offset, size_t length) {
+    return offset <= size && length <= size - offset;
+  };
+
+  const auto *header = reinterpret_cast<const Header *>(m_file.data());
+  if (!inside(0, sizeof(Header)) || header->magic != kMagic ||
+      header->version != kVersion) {
+    throw LevelError("Not a version " + std::to_string(kVersion) +
+                     " compiled level: " + path);
+  }
+  if (!inside(header->assetsOffset,
+              size_t(header->assetCount) * sizeof(uint32_t)) ||
+      !inside(header->entitiesOffset,
+              size_t(header->entityCount) * sizeof(EntityRecord)) ||
+      !inside(header->chunksOffset,
+              size_t(header->chunkCount) * sizeof(ChunkRecord)) ||
+      header->chunkColumns != kChunkColumns ||
+      !inside(header->stringsOffset, header->stringsSize) ||
+      header->stringsSize == 0 ||
+      m_file.data()[header->stringsOffset + header->stringsSize - 1] != '\0' ||
+      header->playerWeapon >= header->assetCount) {
+    throw LevelError("Corrupt compiled level: " + path);
+  }
+
+  const auto *names =
+      reinterpret_cast<const uint32_t *>(m_file.data() + header->assetsOffset);
+  for (uint32_t i = 0; i < header->assetCount; i++) {
+    if (names[i] >= header->stringsSize) {
+      throw LevelError("Corrupt compiled level: " + path);
+    }
+  }
+  const auto *records = reinterpret_cast<const EntityRecord *>(
+      m_file.data() + header->entitiesOffset);
+  for (uint32_t i = 0; i < header->entityCount; i++) {
+    if (records[i].asset >= header->assetCount || records[i].type > Dec) {
+      throw LevelError("Corrupt compiled level: " + path);
+    }
+  }
+
+  const auto *chunks = reinterpret_cast<const ChunkRecord *>(
+      m_file.data() + header->chunksOffset);
+  for (uint32_t i = 0; i < header->chunkCount; i++) {
+    if (chunks[i].firstEntity > header->entityCount ||
+        chunks[i].entityCount > header->entityCount - chunks[i].firstEntity) {
+      throw LevelError("Corrupt compiled level: " + path);
+    }
+  }
+
+  m_header = header;
+}
+
+PlayerConfig CompiledLevel::player() const {
+  PlayerConfig player;
+  player.X = m_header->playerX;
+  player.Y = m_header->playerY;
+  player.CX = m_header->playerCX;
+  player.CY = m_header->playerCY;
+  player.SPEED = m_header->playerSpeed;
+  player.JUMP = m_header->playerJump;
+  player.MAX_SPEED = m_header->playerMaxSpeed;
+  player.GRAVITY = m_header->playerGravity;
+  player.WEAPON = assetName(m_header->playerWeapon);
+  return player;
+}
+
+uint32_t CompiledLevel::assetCount() const { return m_header->assetCount; }
+
+const char *CompiledLevel::assetName(uint32_t i) const {
+  const auto *names = reinterpret_cast<const uint32_t *>(
+      m_file.data() + m_header->assetsOffset);
+  return m_file.data() + m_header->stringsOffset + names[i];
+}
+
+uint32_t CompiledLevel::entityCount() const { return m_header->entityCount; }
+
+const EntityRecord *CompiledLevel::entities() const {
+  return reinterpret_cast<const EntityRecord *>(m_file.data() +
+                                                m_header->entitiesOffset);
+}
+
+uint32_t CompiledLevel::chunkCount() const { return m_header->chunkCount; }
+
+const ChunkRecord *CompiledLevel::chunks() const {
+  return reinterpret_cast<const ChunkRecord *>(m_file.data() +
+                                               m_header->chunksOffset);
+}
+
+std::string compiledLevelPath(const std::string &textPath) {
+  const std::filesystem::path compiled =
+      std::filesystem::path(textPath).replace_extension(".lvl");
+  std::error_code error;
+  const auto compiledTime = std::filesystem::last_write_time(compiled, error);
+  if (error) {
+    return "";
+  }
+  const auto textTime = std::filesystem::last_write_time(textPath, error);
+  if (!error && textTime > compiledTime) {
+    return "";
+  }
+  return compiled.string();
+}
@@ -0,0 +1,108 @@
+#include "../include/LevelGenerator.h"
+#include <algorithm>
+#include <random>
+
+using namespace LevelFormat;
+
+namespace {
+
+// only the raw mt19937 output is pinned down by the standard, the
+// distributions are not, so levels are drawn from it directly to come out
+// the same with every standard library
+class Random {
+  std::mt19937 m_engine;
+
+public:
+  explicit Random(uint32_t seed) : m_engine(seed) {}
+
+  // uniform in [0, 1)
+  double next() { return double(m_engine()) / 4294967296.0; }
+
+  bool chance(double p) { return next() < p; }
+
+  // uniform in [low, high]
+  uint32_t range(uint32_t low, uint32_t high) {
+    return low + uint32_t(next() * double(high - low + 1));
+  }
+};
+
+// the rows platforms sit on, three apart so each is one jump from the last
+constexpr float kPlatformRows[] = {3, 6, 9};
+constexpr size_t kLevelRows = 3;
+constexpr uint32_t kSafeColumns = 8; // no gaps under the spawn or the flag
+constexpr const char *kDecorations[] = {"CloudBig", "CloudSmall", "BushBig",
+                                        "Bush"};
+
+} // namespace
+
+LevelData generateLevel(const LevelGeneratorConfig &config) {
+  LevelData level;
+  Random random(config.seed);
+  level.player = PlayerConfig{2, 6, 48, 48, 5, 20, -20, 0.75f, "Buster"};
+
+  // names are interned on first use like the text parser does, so the
+  // compiled output matches megaMario_levelc run on the text output
+  size_t tiles = 0;
+  auto add = [&](EntityType type, const char *name, float x, float y) {
+    level.entities.push_back(
+        EntityRecord{type, 0, level.internAsset(name), x, y});
+    tiles += type == Tile;
+  };
+
+  const uint32_t length = std::max(config.length, 2 * kSafeColumns);
+  uint32_t runs[kLevelRows] = {}; // columns left of the platform on each row
+  bool gap = false;
+  uint32_t x = 0;
+  for (; x < length - kSafeColumns || tiles < config.tiles; x++) {
+    const float column = float(x);
+
+    // a gap is never wider than one column and never under a platform
+    gap = !gap && x >= kSafeColumns && runs[0] == 0 && random.chance(0.04);
+    if (!gap) {
+      add(Tile, "Ground", column, 0);
+    }
+
+    // a higher row only starts above a platform of the row below
+    for (size_t row = 0; row < kLevelRows; row++) {
+      if (runs[row] == 0 && (row == 0 || runs[row - 1] > 0) &&
+          random.chance(config.density * 0.25 / double(row + 1))) {
+        runs[row] = random.range(1, 6);
+      }
+      if (runs[row] == 0) {
+        continue;
+      }
+      runs[row]--;
+      const char *asset = "Block";
+      if (random.chance(config.breakable)) {
+        asset = "Brick";
+      } else if (random.chance(0.15)) {
+        asset = "Question";
+      }
+      add(Tile, asset, column, kPlatformRows[row]);
+    }
+
+    if (random.chance(config.decorations)) {
+      const uint32_t kind = random.range(0, 3);
+      if (kind < 2) {
+        add(Dec, kDecorations[kind], column, float(random.range(7, 10)));
+      } else if (!gap) {
+        add(Dec, kDecorations[kind], column, 1);
+      }
+    }
+  }
+
+  // solid ground up to the pole, then the pole like the end of level1
+  for (uint32_t end = x + kSafeColumns; x < end; x++) {
+    add(Tile, "Ground", float(x), 0);
+  }
+  const float pole = float(x - 3);
+  add(Dec, "Flag", pole - 0.5f, 6);
+  add(Tile, "Block", pole, 1);
+  for (int y = 2; y <= 6; y++) {
+    add(Tile, "Pole", pole, float(y));
+  }
+  add(Tile, "PoleTop", pole, 7);
+
+  level.buildChunks();
+  return level;
+}
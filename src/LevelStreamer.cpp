@@ -0,0 +1,225 @@
+#include "../include/LevelStreamer.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+LevelStreamer::LevelStreamer() = default;
+
+LevelStreamer::~LevelStreamer() { waitForPending(); }
+
+void LevelStreamer::open(const std::string &fileName,
+                         ThreadPool *threadPool) {
+  PROFILE_SCOPE("LevelStreamer::open");
+  // the workers read the records, they have to be done before they change
+  waitForPending();
+  m_chunks.clear();
+  m_tileOverrides.clear();
+  m_assetNames.clear();
+  m_threadPool = threadPool;
+
+  const std::string compiledPath = compiledLevelPath(fileName);
+  if (!compiledPath.empty()) {
+    m_compiled.open(compiledPath);
+    m_parsed = LevelData();
+    m_player = m_compiled.player();
+    for (uint32_t i = 0; i < m_compiled.assetCount(); i++) {
+      m_assetNames.emplace_back(m_compiled.assetName(i));
+    }
+    m_records = m_compiled.entities();
+    m_recordCount = m_compiled.entityCount();
+    m_chunkTable = m_compiled.chunks();
+    m_chunks.resize(m_compiled.chunkCount());
+  } else {
+    m_parsed = LevelData();
+    m_parsed.loadFromText(fileName);
+    m_player = m_parsed.player;
+    m_assetNames = m_parsed.assets;
+    m_records = m_parsed.entities.data();
+    m_recordCount = m_parsed.entities.size();
+    m_chunkTable = m_parsed.chunks.data();
+    m_chunks.resize(m_parsed.chunks.size());
+  }
+}
+
+const PlayerConfig &LevelStreamer::player() const { return m_player; }
+
+const std::vector<std::string> &LevelStreamer::assetNames() const {
+  return m_assetNames;
+}
+
+void LevelStreamer::setLayout(std::vector<AnimationHandle> animations,
+                              std::vector<Vec2> animationSizes, Vec2 gridSize,
+                              float windowHeight) {
+  waitForPending();
+  m_animations = std::move(animations);
+  m_animationSizes = std::move(animationSizes);
+  m_gridSize = gridSize;
+  m_windowHeight = windowHeight;
+}
+
+void LevelStreamer::setSpawner(Spawner spawner) {
+  m_spawner = std::move(spawner);
+}
+
+void LevelStreamer::setSynchronous(bool synchronous) {
+  m_synchronous = synchronous;
+}
+
+LevelStreamer::PreparedChunk LevelStreamer::prepare(size_t index) const {
+  PROFILE_SCOPE("LevelStreamer::prepare");
+  // runs on a worker: only reads the records and the layout, which do not
+  // change while a chunk is pending
+  PreparedChunk prepared;
+  prepared.index = index;
+  const LevelFormat::ChunkRecord &chunk = m_chunkTable[index];
+  prepared.entities.reserve(chunk.entityCount);
+  for (uint32_t i = 0; i < chunk.entityCount; i++) {
+    const uint32_t record = chunk.firstEntity + i;
+    const LevelFormat::EntityRecord &entry = m_records[record];
+    const Vec2 &size = m_animationSizes[entry.asset];
+    ChunkEntity entity;
+    entity.type = LevelFormat::EntityType(entry.type);
+    entity.animation = m_animations[entry.asset];
+    entity.record = record;
+    entity.pos = Vec2(m_gridSize.x * entry.gridX + size.x / 2,
+                      m_windowHeight - m_gridSize.y * entry.gridY - size.y / 2);
+    prepared.entities.push_back(entity);
+  }
+  return prepared;
+}
+
+void LevelStreamer::request(size_t index) {
+  Chunk &chunk = m_chunks[index];
+  if (chunk.state != ChunkState::Unloaded) {
+    return;
+  }
+  chunk.state = ChunkState::Pending;
+  if (m_threadPool) {
+    chunk.pending = m_threadPool->submit([this, index]() {
+      return prepare(index);
+    });
+  } else {
+    std::promise<PreparedChunk> ready;
+    ready.set_value(prepare(index));
+    chunk.pending = ready.get_future();
+  }
+}
+
+void LevelStreamer::spawn(PreparedChunk prepared) {
+  PROFILE_SCOPE("LevelStreamer::spawn");
+  Chunk &chunk = m_chunks[prepared.index];
+  chunk.state = ChunkState::Resident;
+  chunk.entities.reserve(prepared.entities.size());
+  for (ChunkEntity &entity : prepared.entities) {
+    auto changed = m_tileOverrides.find(entity.record);
+    if (changed != m_tileOverrides.end()) {
+      if (!changed->second.isValid()) {
+        continue;
+      }
+      entity.animation = changed->second;
+    }
+    if (auto spawned = m_spawner(entity)) {
+      chunk.entities.push_back(std::move(spawned));
+    }
+  }
+}
+
+void LevelStreamer::unload(size_t index) {
+  Chunk &chunk = m_chunks[index];
+  for (auto &entity : chunk.entities) {
+    entity->destroy();
+  }
+  chunk.entities.clear();
+  chunk.state = ChunkState::Unloaded;
+}
+
+void LevelStreamer::waitForPending() {
+  for (auto &chunk : m_chunks) {
+    if (chunk.pending.valid()) {
+      chunk.pending.wait();
+    }
+  }
+}
+
+void LevelStreamer::update(float viewLeft, float viewRight) {
+  if (m_chunks.empty()) {
+    return;
+  }
+
+  const float chunkWidth = m_gridSize.x * LevelFormat::kChunkColumns;
+  auto chunkAt = [&](float x) {
+    const float chunk = std::floor(x / chunkWidth);
+    return size_t(std::clamp(chunk, 0.0f, float(m_chunks.size() - 1)));
+  };
+  const size_t first = chunkAt(viewLeft);
+  const size_t last = chunkAt(viewRight);
+  const size_t prefetchFirst = first - std::min(first, kPrefetchChunks);
+  const size_t prefetchLast =
+      std::min(m_chunks.size() - 1, last + kPrefetchChunks);
+  const size_t keepFirst = first - std::min(first, kKeepChunks);
+  const size_t keepLast = std::min(m_chunks.size() - 1, last + kKeepChunks);
+
+  for (size_t i = prefetchFirst; i <= prefetchLast; i++) {
+    request(i);
+  }
+
+  for (size_t i = 0; i < m_chunks.size(); i++) {
+    Chunk &chunk = m_chunks[i];
+    const bool keep = i >= keepFirst && i <= keepLast;
+    if (chunk.state == ChunkState::Pending) {
+      // chunks in view can not wait for the next frame
+      const bool inView = i >= first && i <= last;
+      if (inView || m_synchronous ||
+          chunk.pending.wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready) {
+        PreparedChunk prepared = chunk.pending.get();
+        if (keep) {
+          spawn(std::move(prepared));
+        } else {
+          chunk.state = ChunkState::Unloaded;
+        }
+      }
+    } else if (chunk.state == ChunkState::Resident && !keep) {
+      unload(i);
+    }
+  }
+}
+
+void LevelStreamer::reset() {
+  waitForPending();
+  for (auto &chunk : m_chunks) {
+    chunk = Chunk();
+  }
+  m_tileOverrides.clear();
+}
+
+void LevelStreamer::destroyTile(uint32_t record) {
+  m_tileOverrides[record] = AnimationHandle();
+}
+
+void LevelStreamer::replaceTile(uint32_t record, AnimationHandle animation) {
+  m_tileOverrides[record] = animation;
+}
+
+void LevelStreamer::keepChangedTiles(const LevelStreamer &previous) {
+  // records are indices into the file, an edit above a tile moves it
+  for (const auto &[record, animation] : previous.m_tileOverrides) {
+    if (record >= m_recordCount || record >= previous.m_recordCount) {
+      continue;
+    }
+    const LevelFormat::EntityRecord &now = m_records[record];
+    const LevelFormat::EntityRecord &before = previous.m_records[record];
+    if (now.type == before.type && now.gridX == before.gridX &&
+        now.gridY == before.gridY &&
+        m_assetNames[now.asset] == previous.m_assetNames[before.asset]) {
+      m_tileOverrides[record] = animation;
+    }
+  }
+}
+
+size_t LevelStreamer::residentChunks() const {
+  return size_t(std::count_if(
+      m_chunks.begin(), m_chunks.end(),
+      [](const Chunk &chunk) { return chunk.state == ChunkState::Resident; }));
+}
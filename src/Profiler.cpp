@@ -0,0 +1,142 @@
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string_view>
+
+Profiler::Profiler() : m_slots(std::make_unique<Slot[]>(kCapacity)) {}
+
+Profiler &Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+uint64_t Profiler::now() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - epoch)
+                      .count());
+}
+
+uint32_t Profiler::threadNumber() {
+  static std::atomic<uint32_t> threads{0};
+  thread_local const uint32_t number = threads.fetch_add(1);
+  return number;
+}
+
+void Profiler::record(const char *name, uint64_t start, uint64_t end,
+                      uint64_t allocations, uint64_t bytes) {
+  const uint64_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = m_slots[index & (kCapacity - 1)];
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.start.store(start, std::memory_order_relaxed);
+  slot.end.store(end, std::memory_order_relaxed);
+  slot.thread.store(threadNumber(), std::memory_order_relaxed);
+  slot.allocations.store(allocations, std::memory_order_relaxed);
+  slot.bytes.store(bytes, std::memory_order_relaxed);
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<Profiler::Event> Profiler::snapshot() const {
+  const uint64_t next = m_next.load(std::memory_order_acquire);
+  const uint64_t first = next > kCapacity ? next - kCapacity : 0;
+
+  std::vector<Event> events;
+  events.reserve(size_t(next - first));
+  for (uint64_t index = first; index < next; index++) {
+    const Slot &slot = m_slots[index & (kCapacity - 1)];
+    const uint64_t written = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != written) {
+      continue; // still being written, or already overwritten
+    }
+    Event event;
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.start = slot.start.load(std::memory_order_relaxed);
+    event.end = slot.end.load(std::memory_order_relaxed);
+    event.thread = slot.thread.load(std::memory_order_relaxed);
+    event.allocations = slot.allocations.load(std::memory_order_relaxed);
+    event.bytes = slot.bytes.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == written) {
+      events.push_back(event);
+    }
+  }
+  return events;
+}
+
+std::vector<Profiler::ZoneStats> Profiler::summarize(uint64_t window) const {
+  const uint64_t current = now();
+  const uint64_t since = current > window ? current - window : 0;
+
+  // the same literal can have a different address in every translation unit
+  std::map<std::string_view, std::vector<uint64_t>> durations;
+  std::map<std::string_view, Allocations::Counts> allocations;
+  for (const auto &event : snapshot()) {
+    if (event.end >= since) {
+      durations[event.name].push_back(event.end - event.start);
+      allocations[event.name].count += event.allocations;
+      allocations[event.name].bytes += event.bytes;
+    }
+  }
+
+  std::vector<ZoneStats> zones;
+  zones.reserve(durations.size());
+  for (auto &[name, samples] : durations) {
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+      return double(samples[size_t(p * double(samples.size() - 1))]) / 1e6;
+    };
+    ZoneStats zone;
+    zone.name = std::string(name);
+    zone.count = samples.size();
+    zone.p50 = percentile(0.5);
+    zone.p99 = percentile(0.99);
+    zone.max = double(samples.back()) / 1e6;
+    zone.allocations = allocations[name].count;
+    zone.bytes = allocations[name].bytes;
+    zones.push_back(zone);
+  }
+  return zones;
+}
+
+bool Profiler::writeCsv(const std::string &path) const {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+  file << std::fixed << std::setprecision(3);
+  file << "zone,thread,start_us,duration_us,allocations,bytes\n";
+  for (const auto &event : snapshot()) {
+    file << event.name << ',' << event.thread << ','
+         << double(event.start) / 1e3 << ','
+         << double(event.end - event.start) / 1e3 << ',' << event.allocations
+         << ',' << event.bytes << '\n';
+  }
+  return bool(file);
+}
+
+bool Profiler::writeTrace(const std::string &path) const {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+  // complete ("X") events, timestamps in microseconds
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto &event : snapshot()) {
+    file << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name
+         << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+         << ",\"ts\":" << double(event.start) / 1e3
+         << ",\"dur\":" << double(event.end - event.start) / 1e3
+         << ",\"args\":{\"allocations\":" << event.allocations
+         << ",\"bytes\":" << event.bytes << "}}";
+    first = false;
+  }
+  file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return bool(file);
+}
@@ -0,0 +1,92 @@
+#include "../include/ProfilerOverlay.h"
+#include "../include/Profiler.h"
+#include "../include/Scene.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+ProfilerOverlay::ProfilerOverlay(Assets *assets, const FramePacer *framePacer,
+                                 const InputQueue *inputQueue)
+    : m_assets(assets), m_framePacer(framePacer), m_inputQueue(inputQueue),
+      m_assetScope(assets) {
+  m_text.setCharacterSize(14);
+  m_text.setFillColor(sf::Color::White);
+  m_text.setPosition(8, 8);
+  m_background.setFillColor(sf::Color(0, 0, 0, 160));
+  m_background.setPosition(0, 0);
+}
+
+void ProfilerOverlay::toggle() {
+  if (!m_visible && m_text.getFont() == nullptr) {
+    // the catalogue is empty until Scene_Loading registered it
+    try {
+      m_text.setFont(m_assets->getFont(m_assetScope.requireFont("Arial")));
+    } catch (const AssetError &e) {
+      std::cerr << "Profiler overlay: " << e.what() << std::endl;
+      return;
+    }
+  }
+  m_visible = !m_visible;
+  m_framesUntilRefresh = 0;
+}
+
+void ProfilerOverlay::refresh(Scene &scene) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(2);
+  text << "zone (last 2 s)          p50 ms   p99 ms  allocs  bytes\n";
+  for (const auto &zone : Profiler::instance().summarize(2000000000)) {
+    // allocations per call, which for the systems is per frame
+    const double calls = double(zone.count);
+    text << std::left << std::setw(24) << zone.name << std::right
+         << std::setw(9) << zone.p50 << std::setw(9) << zone.p99
+         << std::setprecision(1) << std::setw(8)
+         << double(zone.allocations) / calls << std::setprecision(0)
+         << std::setw(7) << double(zone.bytes) / calls << std::setprecision(2)
+         << "\n";
+  }
+
+  // the 1% low is what shows as stutter, the average hides it
+  const FramePacer::Stats pacing = m_framePacer->stats();
+  text << "\nframes (last " << pacing.frames << ")\n"
+       << "avg " << pacing.averageMs << " ms  p50 " << pacing.p50Ms
+       << " ms  1% low " << pacing.p99Ms << " ms  max " << pacing.maxMs
+       << " ms\n";
+  if (pacing.targetHz > 0) {
+    text << "target " << std::setprecision(0) << pacing.targetHz << " Hz  "
+         << pacing.missed << " missed" << std::setprecision(2) << "\n";
+  }
+  const InputQueue::LatencyStats latency = m_inputQueue->latency();
+  if (latency.samples > 0) {
+    text << "input to photon (last " << latency.samples << ")\n"
+         << "avg " << latency.averageMs << " ms  max " << latency.maxMs
+         << " ms  last " << latency.lastMs << " ms\n";
+  }
+  text << "\nentities\n";
+  for (const auto &[tag, entities] : scene.entityManager().getEntityMap()) {
+    text << std::left << std::setw(24) << tag << std::right << std::setw(9)
+         << entities.size() << "\n";
+  }
+  m_text.setString(text.str());
+
+  const sf::FloatRect bounds = m_text.getGlobalBounds();
+  m_background.setSize(sf::Vector2f(bounds.left + bounds.width + 8,
+                                    bounds.top + bounds.height + 8));
+}
+
+void ProfilerOverlay::draw(sf::RenderWindow &window, Scene &scene) {
+  if (!m_visible) {
+    return;
+  }
+  if (m_framesUntilRefresh == 0) {
+    refresh(scene);
+    m_framesUntilRefresh = m_refreshFrames;
+  }
+  m_framesUntilRefresh--;
+
+  // drawn in window coordinates, whatever the scene's view is
+  const sf::View view = window.getView();
+  window.setView(window.getDefaultView());
+  window.draw(m_background);
+  window.draw(m_text);
+  window.setView(view);
+}
@@ -0,0 +1,100 @@
+#include "../include/Replay.h"
+
+using namespace ReplayFormat;
+
+static bool before(const Record &record, uint32_t scene, uint32_t tick) {
+  return record.scene < scene || (record.scene == scene && record.tick < tick);
+}
+
+ReplayRecorder::ReplayRecorder() = default;
+
+void ReplayRecorder::open(const std::string &path) {
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  const Header header;
+  m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (!m_file) {
+    throw ReplayError("Could not write replay: " + path);
+  }
+}
+
+bool ReplayRecorder::isOpen() const { return m_file.is_open(); }
+
+void ReplayRecorder::action(uint32_t scene, uint32_t tick,
+                            const Action &action) {
+  Record record;
+  record.scene = scene;
+  record.tick = tick;
+  record.kind = Input;
+  record.action = uint8_t(action.name());
+  record.type = uint8_t(action.type());
+  m_file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+void ReplayRecorder::checksum(uint32_t scene, uint32_t tick,
+                              uint32_t checksum) {
+  Record record;
+  record.scene = scene;
+  record.tick = tick;
+  record.kind = Checksum;
+  record.checksum = checksum;
+  m_file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+ReplayPlayer::ReplayPlayer() = default;
+
+void ReplayPlayer::open(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  Header header;
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      header.magic != kMagic || header.version != kVersion) {
+    throw ReplayError("Not a version " + std::to_string(kVersion) +
+                      " replay: " + path);
+  }
+
+  m_records.clear();
+  m_next = 0;
+  Record record;
+  while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+    if (record.kind > Checksum || record.action >= uint8_t(ActionName::Count) ||
+        record.type > uint8_t(ActionType::End) ||
+        (!m_records.empty() &&
+         before(record, m_records.back().scene, m_records.back().tick))) {
+      throw ReplayError("Corrupt replay: " + path);
+    }
+    m_records.push_back(record);
+  }
+  if (file.gcount() != 0) {
+    throw ReplayError("Truncated replay: " + path);
+  }
+}
+
+bool ReplayPlayer::finished() const { return m_next >= m_records.size(); }
+
+void ReplayPlayer::seek(uint32_t scene, uint32_t tick) {
+  while (m_next < m_records.size() && before(m_records[m_next], scene, tick)) {
+    m_next++;
+  }
+}
+
+std::vector<Action> ReplayPlayer::actions(uint32_t scene, uint32_t tick) {
+  seek(scene, tick);
+  std::vector<Action> actions;
+  while (m_next < m_records.size() && m_records[m_next].kind == Input &&
+         m_records[m_next].scene == scene && m_records[m_next].tick == tick) {
+    const Record &record = m_records[m_next++];
+    actions.emplace_back(ActionName(record.action), ActionType(record.type));
+  }
+  return actions;
+}
+
+bool ReplayPlayer::verify(uint32_t scene, uint32_t tick, uint32_t checksum,
+                          uint32_t &expected) {
+  seek(scene, tick);
+  expected = checksum;
+  if (m_next >= m_records.size() || m_records[m_next].kind != Checksum ||
+      m_records[m_next].scene != scene || m_records[m_next].tick != tick) {
+    return true;
+  }
+  expected = m_records[m_next++].checksum;
+  return expected == checksum;
+}
@@ -1,20 +1,90 @@
 #include "../include/Scene.h"
 #include "../include/GameEngine.h"
+#include <cstring>
+#include <iostream>
 
 Scene::Scene() = default;
 
-Scene::Scene(GameEngine *gameEngine) : m_game(gameEngine) {}
+Scene::Scene(GameEngine *gameEngine)
+    : m_game(gameEngine), m_assetScope(&gameEngine->assets()) {}
 
 Scene::~Scene() = default;
 
 void Scene::doAction(const Action &action) { sDoAction(action); }
 
+void Scene::onAssetsReloaded(const std::vector<AnimationHandle> &animations) {}
+
+void Scene::onFileChanged(const std::string &path) {}
+
+void Scene::onResume() {}
+
+bool Scene::isReusable() const { return false; }
+
+void Scene::reset() {}
+
+uint32_t Scene::mixChecksum(uint32_t hash, const void *data, size_t size) {
+  // FNV-1a over the exact bits, a float off by one ulp is a divergence
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+uint32_t Scene::checksum() {
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](const void *data, size_t size) {
+    hash = mixChecksum(hash, data, size);
+  };
+  auto mixFloat = [&mix](float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    mix(&bits, sizeof(bits));
+  };
+
+  for (const auto &entity : m_entityManager.getEntities()) {
+    const uint64_t id = entity->id();
+    const bool active = entity->isActive();
+    mix(&id, sizeof(id));
+    mix(&active, sizeof(active));
+    mix(entity->tag().data(), entity->tag().size());
+    if (entity->hasComponent<CTransform>()) {
+      const auto &transform = entity->getComponent<CTransform>();
+      for (const Vec2 *v : {&transform.pos, &transform.prevPos,
+                            &transform.velocity, &transform.scale}) {
+        mixFloat(v->x);
+        mixFloat(v->y);
+      }
+      mixFloat(transform.angle);
+    }
+    if (entity->hasComponent<CState>()) {
+      const auto &state = entity->getComponent<CState>();
+      const uint64_t animationState = state.animationState;
+      mix(&state.flags, sizeof(state.flags));
+      mix(&animationState, sizeof(animationState));
+    }
+    if (entity->hasComponent<CLifespan>()) {
+      const auto &lifespan = entity->getComponent<CLifespan>();
+      mix(&lifespan.lifespan, sizeof(lifespan.lifespan));
+      mix(&lifespan.frameCreated, sizeof(lifespan.frameCreated));
+    }
+  }
+  return hash;
+}
+
 void Scene::setPaused(bool paused) { m_paused = paused; }
 
 void Scene::simulate(const size_t frames) {}
 
 void Scene::registerAction(int inputKey, const std::string &actionName) {
-  m_actionMap[inputKey] = actionName;
+  const ActionName action = Action::intern(actionName);
+  if (action == ActionName::None || inputKey < 0 ||
+      inputKey >= int(m_actionMap.size())) {
+    std::cerr << "Could not register action " << actionName << " for key "
+              << inputKey << "\n";
+    return;
+  }
+  m_actionMap[inputKey] = action;
 }
 
 size_t Scene::width() const { return m_game->window().getSize().x; }
@@ -23,10 +93,19 @@ size_t Scene::height() const { return m_game->window().getSize().y; }
 
 size_t Scene::currentFrame() const { return m_currentFrame; }
 
+EntityManager &Scene::entityManager() { return m_entityManager; }
+
 bool Scene::hasEnded() const { return m_hasEnded; }
 
 const ActionMap &Scene::getActionMap() const { return m_actionMap; }
 
+ActionName Scene::actionFor(int inputKey) const {
+  if (inputKey < 0 || inputKey >= int(m_actionMap.size())) {
+    return ActionName::None;
+  }
+  return m_actionMap[inputKey];
+}
+
 void Scene::drawLine(const Vec2 &p1, const Vec2 &p2) {
   sf::Vertex line[] = {sf::Vertex(sf::Vector2f(p1.x, p1.y)),
                        sf::Vertex(sf::Vector2f(p2.x, p2.y))};
@@ -0,0 +1,126 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include "Assets.h"
+#include "GameEngine.h"
+#include "Profiler.h"
+#include "Scene_Loading.h"
+#include "Scene_Menu.h"
+
+namespace {
+
+// the bundle loads without any image decoding, but only stands in for the
+// manifest and every image and font file it names while it is newer
+bool isUpToDate(const std::string &bundle, const std::string &manifestPath,
+                const AssetManifest &manifest) {
+  PROFILE_SCOPE("Scene_Loading::isUpToDate");
+  std::error_code error;
+  const auto bundleTime = std::filesystem::last_write_time(bundle, error);
+  if (error) {
+    return false;
+  }
+  std::vector<std::string> sources{manifestPath};
+  for (const auto &entry : manifest.textures) {
+    sources.push_back(entry.path);
+  }
+  for (const auto &entry : manifest.fonts) {
+    sources.push_back(entry.path);
+  }
+  for (const auto &source : sources) {
+    const auto sourceTime = std::filesystem::last_write_time(source, error);
+    if (!error && sourceTime > bundleTime) {
+      std::cerr << bundle << " is older than " << source << ", ignoring it\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+Scene_Loading::Scene_Loading(GameEngine *gameEngine,
+                             const std::string &assetsPath)
+    : Scene(gameEngine), m_assetsPath(assetsPath) {
+  init();
+}
+
+void Scene_Loading::init() {
+  registerAction(sf::Keyboard::Escape, "QUIT");
+
+  // a bundle is only mapped, which the engine does when this is done
+  m_manifest = m_game->threadPool().submit([path = m_assetsPath]() {
+    PROFILE_SCOPE("AssetManifest::loadFromFile");
+    Source source{path};
+    if (Assets::isBundle(path)) {
+      return source;
+    }
+    const std::string bundle =
+        std::filesystem::path(path).replace_extension(".bundle").string();
+    std::error_code error;
+    if (!std::filesystem::exists(path, error) &&
+        std::filesystem::exists(bundle, error)) {
+      source.path = bundle; // shipped without the manifest it came from
+      return source;
+    }
+    source.manifest.loadFromFile(path);
+    if (isUpToDate(bundle, path, source.manifest)) {
+      source.path = bundle;
+    }
+    return source;
+  });
+
+  const sf::Vector2f barSize(float(width()) / 2.0f, 24.0f);
+  const sf::Vector2f barPosition((float(width()) - barSize.x) / 2.0f,
+                                 (float(height()) - barSize.y) / 2.0f);
+  m_progressFrame.setSize(barSize);
+  m_progressFrame.setPosition(barPosition);
+  m_progressFrame.setFillColor(sf::Color::Transparent);
+  m_progressFrame.setOutlineColor(sf::Color::White);
+  m_progressFrame.setOutlineThickness(2);
+  m_progressBar.setPosition(barPosition);
+  m_progressBar.setFillColor(sf::Color::White);
+}
+
+void Scene_Loading::update() {
+  if (m_manifest.valid() && m_manifest.wait_for(std::chrono::seconds(0)) ==
+                                std::future_status::ready) {
+    // rethrows a manifest error, which ends the game as before
+    const Source source = m_manifest.get();
+    m_game->loadAssets(source.path, source.manifest);
+    m_menuFont = m_game->assets().getFontHandle(Scene_Menu::kFont);
+    m_game->assets().prefetch(m_menuFont);
+    m_stepsDone = 1;
+  }
+
+  if (m_menuFont.isValid() && m_game->assets().isReady(m_menuFont)) {
+    m_stepsDone = kSteps;
+    if (m_game->isRendering()) {
+      sRender();
+    }
+    m_game->replaceScene("MENU", std::make_shared<Scene_Menu>(m_game));
+    return;
+  }
+
+  if (m_game->isRendering()) {
+    sRender();
+  }
+}
+
+void Scene_Loading::onEnd() { m_game->quit(); }
+
+void Scene_Loading::sDoAction(const Action &action) {
+  if (action.type() == ActionType::Start && action.name() == ActionName::Quit) {
+    onEnd();
+  }
+}
+
+void Scene_Loading::sRender() {
+  m_game->window().clear(sf::Color(100, 100, 255));
+
+  const sf::Vector2f frameSize = m_progressFrame.getSize();
+  m_progressBar.setSize(sf::Vector2f(
+      frameSize.x * float(m_stepsDone) / float(kSteps), frameSize.y));
+  m_game->window().draw(m_progressBar);
+  m_game->window().draw(m_progressFrame);
+}
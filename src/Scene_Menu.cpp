@@ -1,4 +1,6 @@
 #include <SFML/System/Vector2.hpp>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 
 #include "Action.h"
@@ -18,11 +20,14 @@ void Scene_Menu::init() {
   registerAction(sf::Keyboard::D, "PLAY");
   registerAction(sf::Keyboard::Escape, "QUIT");
 
+  m_font = m_assetScope.requireFont(kFont);
+  const sf::Font &font = m_game->assets().getFont(m_font);
+
   m_title = "Mega Mario";
   int titleSize = 64;
 
   m_menuText.setString(m_title);
-  m_menuText.setFont(m_game->assets().getFont("Megaman"));
+  m_menuText.setFont(font);
   m_menuText.setCharacterSize(titleSize);
 
   m_menuStrings.emplace_back("Level 1");
@@ -30,7 +35,7 @@ void Scene_Menu::init() {
   m_menuStrings.emplace_back("Level 3");
 
   for (int i = 0; i < m_menuStrings.size(); i++) {
-    sf::Text text(m_menuStrings[i], m_game->assets().getFont("Megaman"), 64);
+    sf::Text text(m_menuStrings[i], font, 64);
     if (i != m_selectedMenuIndex) {
       text.setFillColor(sf::Color::Black);
     }
@@ -44,32 +49,157 @@ void Scene_Menu::init() {
   m_levelPaths.emplace_back("level1.txt");
   m_levelPaths.emplace_back("level2.txt");
   m_levelPaths.emplace_back("level3.txt");
+  // an edited level is opened again, see onFileChanged
+  for (const auto &path : m_levelPaths) {
+    m_game->watchFile(path);
+    m_game->watchFile(
+        std::filesystem::path(path).replace_extension(".lvl").string());
+  }
+
+  m_helpText = sf::Text("W:UP  S:DOWN  D:PLAY  ESC:BACK/QUIT", font, 20);
+  m_helpText.setFillColor(sf::Color::Black);
+  m_helpText.setPosition(sf::Vector2f(10, 690));
+
+  startPreloads();
+}
+
+void Scene_Menu::startPreloads() {
+  // every level is opened on the pool while the menu is idle, the
+  // highlighted one first; PLAY then only uploads and spawns what sPreload
+  // decoded. Levels with a cached scene are reused as they are.
+  ThreadPool *threadPool = &m_game->threadPool();
+  m_preloads.resize(m_levelPaths.size());
+  for (size_t n = 0; n < m_levelPaths.size(); n++) {
+    const size_t i = (m_selectedMenuIndex + n) % m_levelPaths.size();
+    if (m_preloads[i].opening.valid() || m_preloads[i].level ||
+        m_game->hasCachedScene("PLAY:" + m_levelPaths[i])) {
+      continue;
+    }
+    m_preloads[i].opening =
+        threadPool->submit([path = m_levelPaths[i], threadPool]() {
+          auto level = std::make_unique<LevelStreamer>();
+          level->open(path, threadPool);
+          return level;
+        });
+  }
+}
+
+void Scene_Menu::sPreload() {
+  // a level that fails is left to Scene_Play to report when it is picked
+  for (auto &preload : m_preloads) {
+    if (!preload.opening.valid() ||
+        preload.opening.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      continue;
+    }
+    try {
+      auto level = preload.opening.get();
+      std::vector<AnimationHandle> animations;
+      for (const auto &name : level->assetNames()) {
+        animations.push_back(m_game->assets().getAnimationHandle(name));
+      }
+      animations.push_back(
+          m_game->assets().getAnimationHandle(level->player().WEAPON));
+      preload.animations = std::move(animations);
+      preload.level = std::move(level);
+    } catch (const std::runtime_error &) {
+    }
+  }
+
+  // the highlighted level gets its textures decoded ahead as well; only the
+  // one, the decoded images are held outside the assets' memory budget
+  const LevelPreload &selected = m_preloads[m_selectedMenuIndex];
+  if (m_prefetched != m_selectedMenuIndex && selected.level) {
+    m_game->assets().prefetch(selected.animations);
+    m_prefetched = m_selectedMenuIndex;
+  }
+}
+
+std::unique_ptr<LevelStreamer> Scene_Menu::takePreload(size_t index) {
+  LevelPreload &preload = m_preloads[index];
+  if (preload.opening.valid()) {
+    // picked before it finished, waiting is still faster than starting over
+    preload.opening.wait();
+    sPreload();
+  }
+  if (m_prefetched == index) {
+    m_prefetched = kNoLevel;
+  }
+  return std::move(preload.level);
 }
 
 void Scene_Menu::update() {
   // m_entityManager.update();
-  sRender();
+  sPreload();
+  if (m_game->isRendering()) {
+    sRender();
+  }
 }
 
 void Scene_Menu::onEnd() { m_game->quit(); }
 
+void Scene_Menu::onResume() {
+  // the picked level took its preload with it
+  startPreloads();
+}
+
+void Scene_Menu::onFileChanged(const std::string &path) {
+  for (size_t i = 0; i < m_levelPaths.size(); i++) {
+    const std::string &levelPath = m_levelPaths[i];
+    if (path != levelPath &&
+        path != std::filesystem::path(levelPath)
+                    .replace_extension(".lvl")
+                    .string()) {
+      continue;
+    }
+    // a preload still opening finishes on its own and is thrown away; a
+    // finished level would start over in place of going back to the old one
+    m_preloads[i] = LevelPreload();
+    if (m_prefetched == i) {
+      m_prefetched = kNoLevel;
+    }
+    m_game->dropCachedScene("PLAY:" + m_levelPaths[i]);
+  }
+  startPreloads();
+}
+
+bool Scene_Menu::isReusable() const { return true; }
+
+void Scene_Menu::reset() { startPreloads(); }
+
 void Scene_Menu::sDoAction(const Action &action) {
-  if (action.type() == "START") {
-    if (action.name() == "UP") {
-      if (m_selectedMenuIndex > 0) {
-        m_selectedMenuIndex--;
-      } else {
-        m_selectedMenuIndex = m_menuStrings.size() - 1;
-      }
-    } else if (action.name() == "DOWN") {
-      m_selectedMenuIndex = (m_selectedMenuIndex + 1) % m_menuStrings.size();
-    } else if (action.name() == "PLAY") {
-      m_game->changeScene("PLAY",
-                          std::make_shared<Scene_Play>(
-                              m_game, m_levelPaths[m_selectedMenuIndex]));
-    } else if (action.name() == "QUIT") {
-      onEnd();
+  if (action.type() != ActionType::Start) {
+    return;
+  }
+
+  switch (action.name()) {
+  case ActionName::Up:
+    if (m_selectedMenuIndex > 0) {
+      m_selectedMenuIndex--;
+    } else {
+      m_selectedMenuIndex = m_menuStrings.size() - 1;
     }
+    break;
+  case ActionName::Down:
+    m_selectedMenuIndex = (m_selectedMenuIndex + 1) % m_menuStrings.size();
+    break;
+  case ActionName::Play: {
+    // a level played recently is reused as is, the menu stays below it
+    const std::string &levelPath = m_levelPaths[m_selectedMenuIndex];
+    const std::string sceneName = "PLAY:" + levelPath;
+    std::shared_ptr<Scene> level = m_game->takeCachedScene(sceneName);
+    if (!level) {
+      level = std::make_shared<Scene_Play>(m_game, levelPath,
+                                           takePreload(m_selectedMenuIndex));
+    }
+    m_game->pushScene(sceneName, level);
+    break;
+  }
+  case ActionName::Quit:
+    onEnd();
+    break;
+  default:
+    break;
   }
 }
 
@@ -93,9 +223,5 @@ void Scene_Menu::sRender() {
   }
 
   // draw help
-  sf::Text help("W:UP  S:DOWN  D:PLAY  ESC:BACK/QUIT",
-                m_game->assets().getFont("Megaman"), 20);
-  help.setFillColor(sf::Color::Black);
-  help.setPosition(sf::Vector2f(10, 690));
-  m_game->window().draw(help);
+  m_game->window().draw(m_helpText);
 }
@@ -1,8 +1,7 @@
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Keyboard.hpp>
 #include <algorithm>
-#include <cstdlib>
-#include <fstream>
+#include <filesystem>
 #include <ios>
 #include <iostream>
 
@@ -10,6 +9,7 @@
 #include "../include/Assets.h"
 #include "../include/Components.h"
 #include "../include/GameEngine.h"
+#include "../include/Profiler.h"
 #include "../include/Scene_Menu.h"
 #include "../include/Scene_Play.h"
 #include "Physics.h"
@@ -17,12 +17,27 @@
 #include "SFML/Graphics/RectangleShape.hpp"
 #include "Vec2.h"
 
-Scene_Play::Scene_Play(GameEngine *gameEngine, const std::string &levelPath)
+namespace {
+
+// the most of each short lived entity alive at once; a bullet lives 100
+// frames and explosions and coins well under a second
+constexpr size_t kMaxBullets = 16;
+constexpr size_t kMaxExplosions = 16;
+constexpr size_t kMaxCoins = 8;
+
+// box tests per collision job, fewer are not worth handing to the pool
+constexpr size_t kMinPairsPerJob = 1 << 14;
+
+} // namespace
+
+Scene_Play::Scene_Play(GameEngine *gameEngine, const std::string &levelPath,
+                       std::unique_ptr<LevelStreamer> level)
     : Scene(gameEngine), m_levelPath(levelPath) {
-  init(levelPath);
+  init(levelPath, std::move(level));
 }
 
-void Scene_Play::init(const std::string &levelPath) {
+void Scene_Play::init(const std::string &levelPath,
+                      std::unique_ptr<LevelStreamer> level) {
   registerAction(sf::Keyboard::P, "PAUSE");
   registerAction(sf::Keyboard::Escape, "QUIT");
   registerAction(sf::Keyboard::T,
@@ -37,72 +52,94 @@ void Scene_Play::init(const std::string &levelPath) {
   registerAction(sf::Keyboard::J, "SHOOT");
 
   m_gridText.setCharacterSize(12);
-  m_gridText.setFont(m_game->assets().getFont("Arial"));
+  m_gridText.setFont(
+      m_game->assets().getFont(m_assetScope.requireFont("Arial")));
   // m_gridText.setFont(m_game->assets().getFont("Tech"));
 
-  loadLevel(levelPath);
+  m_explosionAnimation = m_assetScope.require("Explosion");
+
+  // edits to the level, or to its compiled form, are applied live
+  m_compiledLevelPath =
+      std::filesystem::path(levelPath).replace_extension(".lvl").string();
+  m_game->watchFile(levelPath);
+  m_game->watchFile(m_compiledLevelPath);
+
+  initPlayerAnimations();
+  loadLevel(levelPath, std::move(level));
+}
+
+void Scene_Play::initPlayerAnimations() {
+  // the player animation is picked by the state machine from the CState flags,
+  // the clip is only replaced when the state actually changes
+  const Assets &assets = m_game->assets();
+  const size_t stand = m_playerAnimations.addState(
+      assets.getAnimation(m_assetScope.require("Stand")));
+  const size_t run = m_playerAnimations.addState(
+      assets.getAnimation(m_assetScope.require("Run")));
+  const size_t air = m_playerAnimations.addState(
+      assets.getAnimation(m_assetScope.require("Air")));
+
+  const uint32_t groundMoving = CState::OnGround | CState::Moving;
+  const AnimationCondition inAir{CState::OnGround, 0};
+  const AnimationCondition standing{groundMoving, CState::OnGround};
+  const AnimationCondition running{groundMoving, groundMoving};
+
+  m_playerAnimations.addTransition(stand, air, inAir);
+  m_playerAnimations.addTransition(stand, run, running);
+  m_playerAnimations.addTransition(run, air, inAir);
+  m_playerAnimations.addTransition(run, stand, standing);
+  m_playerAnimations.addTransition(air, stand, standing);
+  m_playerAnimations.addTransition(air, run, running);
+  m_playerAnimations.compile();
 }
 
 Vec2 Scene_Play::gridToMidPixel(float gridX, float gridY,
                                 std::shared_ptr<Entity> entity) {
-  // This function takes in a grid (x,y) position and an Entity
-  //       Return a Vec2 indicating where the CENTER position of the Entity
-  //       should be You must use the Entity's Animation size to position it
-  //       correctly The size of the grid width and height is stored in
-  //       m_gridSize.x and m_gridSize.y The bottom-left corner of the Animation
-  //       should aligh with the bottom left of the grid cell
-  sf::Vector2 windowSize = m_game->window().getSize();
-  float positionByGridX =
-      windowSize.x - (windowSize.x - (m_gridSize.x * gridX));
-  float positionByGridY = windowSize.y - (m_gridSize.y * gridY);
-  Vec2 spriteSize = entity->getComponent<CAnimation>().animation.getSize();
-  Vec2 result = Vec2((positionByGridX + spriteSize.x / 2),
-                     (positionByGridY - spriteSize.y / 2));
-  return result;
+  // The bottom-left corner of the Animation aligns with the bottom-left of
+  // the grid cell, grid y counts up from the bottom of the window
+  const Vec2 size = entity->getComponent<CAnimation>().animation.getSize();
+  return Vec2(m_gridSize.x * gridX + size.x / 2,
+              height() - m_gridSize.y * gridY - size.y / 2);
 }
 
-void Scene_Play::loadLevel(const std::string &fileName) {
-  // reset the entity manager every time we load a level
-  m_entityManager = EntityManager();
-
-  // Reading data in level file here
-  std::ifstream fileInput(fileName);
-  if (!fileInput.is_open()) {
-    std::cerr << "Could not open config file: " << fileName << std::endl;
-    exit(1);
-  }
-  std::string configName;
-  std::string entityName;
-  Vec2 gridPos;
-
-  while (fileInput >> configName) {
-    if (configName == "Tile") {
-      fileInput >> entityName >> gridPos.x >> gridPos.y;
-      auto tileNode = m_entityManager.addEntity("Tile");
-      tileNode->addComponent<CAnimation>(
-          m_game->assets().getAnimation(entityName), true);
-      tileNode->addComponent<CTransform>(
-          gridToMidPixel(gridPos.x, gridPos.y, tileNode));
-      tileNode->getComponent<CTransform>().prevPos =
-          tileNode->getComponent<CTransform>().pos;
-      tileNode->addComponent<CBoundingBox>(
-          m_game->assets().getAnimation(entityName).getSize());
-    } else if (configName == "Dec") {
-      fileInput >> entityName >> gridPos.x >> gridPos.y;
-      auto decNode = m_entityManager.addEntity("Dec");
-      decNode->addComponent<CAnimation>(
-          m_game->assets().getAnimation(entityName), true);
-      decNode->addComponent<CTransform>(
-          gridToMidPixel(gridPos.x, gridPos.y, decNode));
-    } else if (configName == "Player") {
-      fileInput >> m_playerConfig.X >> m_playerConfig.Y >> m_playerConfig.CX >>
-          m_playerConfig.CY >> m_playerConfig.SPEED >> m_playerConfig.JUMP >>
-          m_playerConfig.MAX_SPEED >> m_playerConfig.GRAVITY >>
-          m_playerConfig.WEAPON;
-    }
+void Scene_Play::loadLevel(const std::string &fileName,
+                           std::unique_ptr<LevelStreamer> level) {
+  PROFILE_SCOPE("loadLevel");
+  // only the column chunks around the camera exist as entities, see
+  // sStreaming; a compiled level ('make levels') is mapped as is. The menu
+  // hands over levels it already opened in the background.
+  // Opened and resolved first, a level that fails to load (e.g. while it is
+  // being edited) leaves the running one alone.
+  if (!level) {
+    level = std::make_unique<LevelStreamer>();
+    level->open(fileName, &m_game->threadPool());
+  }
+  const Assets &assets = m_game->assets();
+  std::vector<AnimationHandle> levelAnimations;
+  levelAnimations.reserve(level->assetNames().size() + 1);
+  for (const auto &name : level->assetNames()) {
+    levelAnimations.push_back(assets.getAnimationHandle(name));
   }
+  levelAnimations.push_back(assets.getAnimationHandle(level->player().WEAPON));
+
+  // reset the entity manager every time we load a level
+  resetEntities();
+  m_tileAnimations = AnimationClock();
+  m_levelStreamer = std::move(level);
+  m_playerConfig = m_levelStreamer->player();
+  m_weaponAnimation = levelAnimations.back();
+
+  // the animations the level uses are made resident in one batch, only the
+  // entities themselves are streamed
+  m_assetScope.require(levelAnimations);
+  layoutLevel();
+  m_levelStreamer->setSpawner([this](const ChunkEntity &entity) {
+    return spawnLevelEntity(entity);
+  });
+  m_levelStreamer->setSynchronous(m_game->isDeterministic());
 
   spawnPlayer();
+  sStreaming();
 
   // NOTE: THIS IS INCREDIBLY IMPORTANT PLEASE READ THIS EXAMPLE
   //       Components are now returned as references rather than pointers
@@ -120,12 +157,134 @@ void Scene_Play::loadLevel(const std::string &fileName) {
   //       entity->get<CTransform>()
 }
 
+void Scene_Play::layoutLevel() {
+  // every name is resolved once, chunks are placed from these on the pool
+  const Assets &assets = m_game->assets();
+  std::vector<AnimationHandle> animations;
+  std::vector<Vec2> animationSizes;
+  for (const auto &name : m_levelStreamer->assetNames()) {
+    animations.push_back(assets.getAnimationHandle(name));
+    animationSizes.push_back(assets.getAnimation(animations.back()).getSize());
+  }
+  m_levelStreamer->setLayout(std::move(animations), std::move(animationSizes),
+                             m_gridSize, float(height()));
+}
+
+void Scene_Play::onAssetsReloaded(
+    const std::vector<AnimationHandle> &animations) {
+  // entities hold copies of their animations, the rebuilt ones are swapped
+  // in and the shared clips registered again from scratch
+  const Assets &assets = m_game->assets();
+  std::map<std::string, AnimationHandle> rebuilt;
+  for (const auto handle : animations) {
+    rebuilt[assets.getAnimation(handle).getName()] = handle;
+  }
+
+  // tile types may now reward or turn into animations not required yet
+  std::vector<AnimationHandle> levelAnimations;
+  for (const auto &name : m_levelStreamer->assetNames()) {
+    levelAnimations.push_back(assets.getAnimationHandle(name));
+  }
+  m_assetScope.require(levelAnimations);
+
+  m_playerAnimations = AnimationStateMachine();
+  initPlayerAnimations();
+  m_player->getComponent<CAnimation>().animation = m_playerAnimations.clip(
+      m_player->getComponent<CState>().animationState);
+
+  // entities spawned this tick are only added on the next update, they
+  // hold the same copies
+  m_tileAnimations = AnimationClock();
+  for (auto *entities : {&m_entityManager.getEntities(),
+                         &m_entityManager.getPendingEntities()}) {
+    for (auto &entity : *entities) {
+      if (entity == m_player || !entity->hasComponent<CAnimation>()) {
+        continue;
+      }
+      auto &animation = entity->getComponent<CAnimation>();
+      auto it = rebuilt.find(animation.animation.getName());
+      if (it != rebuilt.end()) {
+        animation.animation = assets.getAnimation(it->second);
+        if (entity->hasComponent<CBoundingBox>()) {
+          entity->addComponent<CBoundingBox>(animation.animation.getSize());
+        }
+      }
+      animation.sharedClip =
+          AnimationClock::isShareable(animation.animation)
+              ? int(m_tileAnimations.registerClip(animation.animation))
+              : -1;
+      if (entity->hasComponent<CTileProperties>()) {
+        auto &tile = entity->getComponent<CTileProperties>();
+        tile = CTileProperties(
+            assets.getTileProperties(
+                assets.getAnimationHandle(animation.animation.getName())),
+            tile.record);
+      }
+    }
+  }
+
+  layoutLevel();
+}
+
+void Scene_Play::onFileChanged(const std::string &path) {
+  if (path != m_levelPath && path != m_compiledLevelPath) {
+    return;
+  }
+  // the level is rebuilt around the player, who keeps going from where it is,
+  // and the tiles broken or bumped so far stay that way
+  auto level = std::make_unique<LevelStreamer>();
+  level->open(m_levelPath, &m_game->threadPool());
+  level->keepChangedTiles(*m_levelStreamer);
+  const CTransform transform = m_player->getComponent<CTransform>();
+  const CInput input = m_player->getComponent<CInput>();
+  const CState state = m_player->getComponent<CState>();
+  loadLevel(m_levelPath, std::move(level));
+  m_player->getComponent<CTransform>() = transform;
+  m_player->getComponent<CInput>() = input;
+  m_player->getComponent<CState>() = state;
+  m_player->getComponent<CAnimation>().animation =
+      m_playerAnimations.clip(state.animationState);
+  sStreaming();
+}
+
+std::shared_ptr<Entity>
+Scene_Play::spawnLevelEntity(const ChunkEntity &levelEntity) {
+  const Assets &assets = m_game->assets();
+  const Animation &animation = assets.getAnimation(levelEntity.animation);
+  if (levelEntity.type == LevelFormat::Tile) {
+    auto tileNode = m_entityManager.addEntity("Tile");
+    auto &tileAnimation = tileNode->addComponent<CAnimation>(animation, true);
+    if (AnimationClock::isShareable(tileAnimation.animation)) {
+      tileAnimation.sharedClip =
+          int(m_tileAnimations.registerClip(tileAnimation.animation));
+    }
+    tileNode->addComponent<CTransform>(levelEntity.pos).prevPos =
+        levelEntity.pos;
+    tileNode->addComponent<CBoundingBox>(animation.getSize());
+    tileNode->addComponent<CTileProperties>(
+        assets.getTileProperties(levelEntity.animation), levelEntity.record);
+    return tileNode;
+  }
+
+  auto decNode = m_entityManager.addEntity("Dec");
+  decNode->addComponent<CAnimation>(animation, true);
+  decNode->addComponent<CTransform>(levelEntity.pos);
+  return decNode;
+}
+
+void Scene_Play::resetEntities() {
+  m_entityManager = EntityManager();
+  m_entityManager.addPool("Bullet", kMaxBullets);
+  m_entityManager.addPool("Explosion", kMaxExplosions);
+  m_entityManager.addPool("Coin", kMaxCoins);
+}
+
 void Scene_Play::spawnPlayer() {
   // here is a sample player entity which you can use to construct other
   // entities
   m_player = m_entityManager.addEntity("player");
-  m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Stand"),
-                                     true);
+  m_player->addComponent<CAnimation>(m_playerAnimations.clip(0), true);
+  m_player->addComponent<CState>(0);
   m_player->addComponent<CTransform>(
       gridToMidPixel(m_playerConfig.X, m_playerConfig.Y, m_player));
   m_player->addComponent<CBoundingBox>(
@@ -137,31 +296,76 @@ void Scene_Play::spawnBullet(std::shared_ptr<Entity> entity) {
   // This spawn a bullet at the given entity, going in the
   // direction the entity is facing
   auto bulletNode = m_entityManager.addEntity("Bullet");
+  if (!bulletNode) {
+    return; // all of them are in flight
+  }
   auto entityPosition = entity->getComponent<CTransform>().pos;
-  bulletNode->addComponent<CAnimation>(
-      m_game->assets().getAnimation(m_playerConfig.WEAPON), true);
+  const Animation &weapon = m_game->assets().getAnimation(m_weaponAnimation);
+  bulletNode->addComponent<CAnimation>(weapon, true);
   bulletNode->addComponent<CTransform>(entityPosition);
   bulletNode->addComponent<CLifespan>(
       100, 0); // 100 is lifespan time of bullet, and 0 is start frame
-  bulletNode->addComponent<CBoundingBox>(
-      m_game->assets().getAnimation(m_playerConfig.WEAPON).getSize());
-  if (m_playerLookDiraction == "left") {
+  bulletNode->addComponent<CBoundingBox>(weapon.getSize());
+  if (entity->getComponent<CState>().test(CState::FacingLeft)) {
     bulletNode->getComponent<CTransform>().velocity.x = -1;
-  } else if (m_playerLookDiraction == "right") {
+  } else {
     bulletNode->getComponent<CTransform>().velocity.x = 1;
   }
 }
 
 void Scene_Play::update() {
-  m_entityManager.update();
+  // before the entity manager update so streamed chunks are live this frame
+  {
+    PROFILE_SCOPE("sStreaming");
+    sStreaming();
+  }
+  {
+    PROFILE_SCOPE("EntityManager::update");
+    m_entityManager.update();
+  }
+  m_currentFrame++;
 
   // TODO: implement pause functionality
 
-  sMovement();
-  sLifespan();
-  sCollision();
-  sAnimation();
-  sRender();
+  {
+    PROFILE_SCOPE("sMovement");
+    sMovement();
+  }
+  {
+    PROFILE_SCOPE("sLifespan");
+    sLifespan();
+  }
+  {
+    PROFILE_SCOPE("sCollision");
+    sCollision();
+  }
+  {
+    PROFILE_SCOPE("sPlayerContacts");
+    sPlayerContacts();
+  }
+  {
+    PROFILE_SCOPE("sTileContacts");
+    sTileContacts();
+  }
+  {
+    PROFILE_SCOPE("sAnimation");
+    sAnimation();
+  }
+  if (m_game->isRendering()) {
+    PROFILE_SCOPE("sRender");
+    sRender();
+  }
+}
+
+float Scene_Play::viewCenterX() const {
+  // the view follows the player once it is far enough right
+  return std::max(width() / 2.0f,
+                  m_player->getComponent<CTransform>().pos.x);
+}
+
+void Scene_Play::sStreaming() {
+  const float viewLeft = viewCenterX() - width() / 2.0f;
+  m_levelStreamer->update(viewLeft, viewLeft + width());
 }
 
 void Scene_Play::sMovement() {
@@ -169,27 +373,25 @@ void Scene_Play::sMovement() {
   auto &velocity = transform.velocity;
   auto gravity = m_player->getComponent<CGravity>().gravity;
   auto &input = m_player->getComponent<CInput>();
-  auto &anim = m_player->getComponent<CAnimation>().animation;
+  auto &state = m_player->getComponent<CState>();
   // Track previous position before any changes
   transform.prevPos = transform.pos;
 
   //
   // === JUMP LOGIC ===
   //
-  if (input.up && m_playerOnGround && !m_isJumping) {
+  if (input.up && state.test(CState::OnGround) && !m_isJumping) {
     // Start jump
     velocity.y = m_playerConfig.JUMP;
     m_isJumping = true;
     m_jumpTime = 0.0f;
-    m_playerOnGround = false;
+    state.set(CState::OnGround, false);
     // std::cout << "Jump Start! Velocity.y = " << velocity.y << "\n";
   }
 
   // Holding jump: allow extended jump height while going upward
   if (input.up && m_isJumping) {
     m_jumpTime += 1.0f / m_game->m_frameLimit; // assume 60 FPS
-    m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Air"),
-                                       true);
     if (m_jumpTime < m_maxJumpTime) {
       // Optional: slightly reduce gravity during hold
       velocity.y += -gravity * 0.5f;
@@ -219,51 +421,17 @@ void Scene_Play::sMovement() {
   //
   // === HORIZONTAL INPUT ===
   //
+  // the animation itself is chosen in sAnimation from these flags
   if (input.left) {
     velocity.x = -m_playerConfig.SPEED;
-    if (m_playerOnGround) {
-      if (anim.getName() != "Run") {
-        m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Run"),
-                                           true);
-      }
-    } else {
-      m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Air"),
-                                         true);
-    }
-    anim.setFlipped(true);
-    m_playerLookDiraction = "left";
-    m_animationIsFlipped = true;
+    state.set(CState::FacingLeft, true);
   } else if (input.right) {
     velocity.x = m_playerConfig.SPEED;
-    if (m_playerOnGround) {
-      if (anim.getName() != "Run") {
-        m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Run"),
-                                           true);
-      }
-    } else {
-      m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Air"),
-                                         true);
-    }
-    anim.setFlipped(false);
-    m_playerLookDiraction = "right";
-    m_animationIsFlipped = false;
+    state.set(CState::FacingLeft, false);
   } else {
     velocity.x = 0;
-    if (m_playerOnGround) {
-      m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Stand"),
-                                         true);
-    } else {
-      m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Air"),
-                                         true);
-    }
-    if (m_playerLookDiraction == "left") {
-      anim.setFlipped(true);
-      m_animationIsFlipped = true;
-    } else {
-      anim.setFlipped(false);
-      m_animationIsFlipped = false;
-    }
   }
+  state.set(CState::Moving, input.left || input.right);
 
   //
   // === APPLY MOVEMENT ===
@@ -297,64 +465,141 @@ void Scene_Play::sCollision() {
   //           GREATER than it Also, something ABOVE something else will
   //           hava a y value LESS than it
 
+  // the boxes are packed once, detection then only reads the packed data
+  // and leaves every side effect to the contact systems below
+  // sized like the entity vectors, so they only grow when those do
+  const EntityVec &tiles = m_entityManager.getEntities("Tile");
+  const EntityVec &bullets = m_entityManager.getEntities("Bullet");
+  m_tileBoxes.clear();
+  m_tileBoxes.reserve(tiles.capacity());
+  for (const auto &tile : tiles) {
+    m_tileBoxes.push_back({&tile, tile->getComponent<CTransform>().pos,
+                           tile->getComponent<CBoundingBox>().halfSize,
+                           tile->getComponent<CTileProperties>().flags});
+  }
+  m_bulletBoxes.clear();
+  m_bulletBoxes.reserve(bullets.capacity());
+  for (const auto &bullet : bullets) {
+    m_bulletBoxes.push_back({&bullet, bullet->getComponent<CTransform>().pos,
+                             bullet->getComponent<CBoundingBox>().halfSize});
+  }
+  const CollisionBox player{&m_player, m_player->getComponent<CTransform>().pos,
+                            m_player->getComponent<CBoundingBox>().halfSize};
+
+  // every job tests the player and all bullets against its range of tiles
+  auto detect = [this, &player](size_t begin, size_t end,
+                                FrameVector<Contact> &contacts) {
+    for (size_t i = begin; i < end; i++) {
+      const CollisionBox &tile = m_tileBoxes[i];
+      Vec2 overlap = Physics::BoxOverlap(player.pos, player.halfSize,
+                                         tile.pos, tile.halfSize);
+      if (overlap.x != 0 && overlap.y != 0) {
+        contacts.push_back(Contact::fromOverlap(Contact::Player, 0,
+                                                uint32_t(i), overlap,
+                                                tile.flags));
+      }
+      for (size_t j = 0; j < m_bulletBoxes.size(); j++) {
+        const CollisionBox &bullet = m_bulletBoxes[j];
+        overlap = Physics::BoxOverlap(bullet.pos, bullet.halfSize, tile.pos,
+                                      tile.halfSize);
+        if (overlap.x != 0 && overlap.y != 0) {
+          contacts.push_back(Contact::fromOverlap(Contact::Bullet,
+                                                  uint32_t(j), uint32_t(i),
+                                                  overlap, tile.flags));
+        }
+      }
+    }
+  };
+
+  // handing a job to the pool allocates, so only levels with a lot of
+  // tiles on screen are split; the main thread takes the first range
+  FrameArena &arena = m_game->frameArena();
+  const size_t pairs = m_tileBoxes.size() * (m_bulletBoxes.size() + 1);
+  const size_t jobs = std::clamp<size_t>(pairs / kMinPairsPerJob, 1,
+                                         m_game->threadPool().size() + 1);
+  const size_t tilesPerJob = (m_tileBoxes.size() + jobs - 1) / jobs;
+  FrameVector<FrameVector<Contact>> jobContacts{
+      FrameAllocator<FrameVector<Contact>>(arena)};
+  jobContacts.reserve(jobs);
+  for (size_t job = 0; job < jobs; job++) {
+    jobContacts.emplace_back(FrameAllocator<Contact>(arena.sub(job)));
+  }
+  FrameVector<std::future<void>> pending{
+      FrameAllocator<std::future<void>>(arena)};
+  for (size_t job = 1; job < jobs; job++) {
+    const size_t begin = std::min(job * tilesPerJob, m_tileBoxes.size());
+    const size_t end = std::min(begin + tilesPerJob, m_tileBoxes.size());
+    pending.push_back(m_game->threadPool().submit(
+        [&detect, &jobContacts, job, begin, end] {
+          detect(begin, end, jobContacts[job]);
+        }));
+  }
+  detect(0, std::min(tilesPerJob, m_tileBoxes.size()), jobContacts[0]);
+  for (auto &job : pending) {
+    job.get();
+  }
+
+  // in the same order however the tiles were split
+  m_contacts.clear();
+  for (const auto &contacts : jobContacts) {
+    m_contacts.insert(m_contacts.end(), contacts.begin(), contacts.end());
+  }
+  std::sort(m_contacts.begin(), m_contacts.end(),
+            [](const Contact &a, const Contact &b) {
+              if (a.kind != b.kind) {
+                return a.kind < b.kind;
+              }
+              return a.other != b.other ? a.other < b.other : a.tile < b.tile;
+            });
+}
+
+void Scene_Play::sPlayerContacts() {
   //
   // Collisions of tile with player BEGIN
   //
-  m_playerOnGround = false;
+  auto &playerState = m_player->getComponent<CState>();
+  playerState.set(CState::OnGround, false);
   Vec2 &playerPosition = m_player->getComponent<CTransform>().pos;
-  for (auto &entityNode : m_entityManager.getEntities("Tile")) {
-    Vec2 overlap = m_worldPhysics.GetOverlap(m_player, entityNode);
-    if (overlap.x != 0 && overlap.y != 0) {
-      Vec2 previousOverlap =
-          m_worldPhysics.GetPreviousOverlap(m_player, entityNode);
-      auto &velocity = m_player->getComponent<CTransform>().velocity;
-      auto entityName =
-          entityNode->getComponent<CAnimation>().animation.getName();
-      if (entityName == "Flag" || entityName == "Pole" ||
-          entityName == "PoleTop") {
-        m_player->addComponent<CTransform>(
-            gridToMidPixel(m_playerConfig.X, m_playerConfig.Y, m_player));
-      }
-      if (std::abs(overlap.x) < std::abs(overlap.y)) {
-        playerPosition.x += overlap.x;
-      } else {
-        playerPosition.y += overlap.y;
-
-        if (overlap.y < 0) {
-          // Landed on top of tile
-          m_playerOnGround = true;
-          velocity.y = 0;
-          if (m_player->getComponent<CAnimation>().animation.getName() ==
-              "Air") {
-            m_player->addComponent<CAnimation>(
-                m_game->assets().getAnimation("Stand"), true);
-          }
-        } else if (overlap.y > 0 && velocity.y < 0) {
-          // Hit head on bottom of tile while jumping
-          velocity.y = 0;
-          if (entityName == "Brick") {
-            Vec2 positionEntityNode =
-                entityNode->getComponent<CTransform>().pos;
-            entityNode->destroy();
-            auto explodeNode = m_entityManager.addEntity("Explosion");
-            explodeNode->addComponent<CAnimation>(
-                m_game->assets().getAnimation("Explosion"), true);
-            explodeNode->addComponent<CTransform>(positionEntityNode);
-          } else if (entityName == "Question") {
-            entityNode->addComponent<CAnimation>(
-                m_game->assets().getAnimation("Question2"), true);
-            Vec2 entityPosition = entityNode->getComponent<CTransform>().pos;
-            auto coinNode = m_entityManager.addEntity("Coin");
-            coinNode->addComponent<CAnimation>(
-                m_game->assets().getAnimation("Coin"), true);
-            coinNode->addComponent<CTransform>(entityPosition);
-            coinNode->getComponent<CTransform>().pos.y -=
-                entityNode->getComponent<CAnimation>().animation.getSize().y;
-          }
-        } else {
-          m_playerOnGround = false;
-        }
-      }
+  auto &velocity = m_player->getComponent<CTransform>().velocity;
+  const Vec2 playerHalfSize = m_player->getComponent<CBoundingBox>().halfSize;
+
+  // the detected contacts only say where the first one is; from there on
+  // the tiles are tested at the player's current position, since resolving
+  // one contact can push the player into a tile it did not touch before
+  const size_t first =
+      m_contacts.empty() || m_contacts[0].kind != Contact::Player
+          ? m_tileBoxes.size()
+          : m_contacts[0].tile;
+  for (size_t i = first; i < m_tileBoxes.size(); i++) {
+    const CollisionBox &tile = m_tileBoxes[i];
+    const Vec2 overlap = Physics::BoxOverlap(playerPosition, playerHalfSize,
+                                             tile.pos, tile.halfSize);
+    if (overlap.x == 0 || overlap.y == 0) {
+      continue;
+    }
+    if (tile.flags & TileProperties::Goal) {
+      m_player->addComponent<CTransform>(
+          gridToMidPixel(m_playerConfig.X, m_playerConfig.Y, m_player));
+      continue;
+    }
+    if (!(tile.flags & TileProperties::Solid)) {
+      continue;
+    }
+
+    const Contact contact = Contact::fromOverlap(
+        Contact::Player, 0, uint32_t(i), overlap, tile.flags);
+    playerPosition += contact.normal * contact.depth;
+    if (contact.normal.y < 0) {
+      // Landed on top of tile
+      playerState.set(CState::OnGround, true);
+      velocity.y = 0;
+    } else if (contact.normal.y > 0 && velocity.y < 0) {
+      // Hit head on bottom of tile while jumping
+      velocity.y = 0;
+      m_contacts.push_back(Contact::fromOverlap(
+          Contact::Head, 0, contact.tile, overlap, tile.flags));
+    } else if (contact.normal.y > 0) {
+      playerState.set(CState::OnGround, false);
     }
   }
 
@@ -383,81 +628,151 @@ void Scene_Play::sCollision() {
   //
   // Player has fallen down END
   //
+}
 
-  //
-  // Bullet collision BEGIN
-  //
-  for (auto &bulletNode : m_entityManager.getEntities("Bullet")) {
-    for (auto &entityNode : m_entityManager.getEntities("Tile")) {
-      Vec2 overlap = m_worldPhysics.GetOverlap(bulletNode, entityNode);
-      if (overlap.x != 0 && overlap.y != 0) {
-        bulletNode->destroy();
-        auto entityName =
-            entityNode->getComponent<CAnimation>().animation.getName();
-        if (entityName == "Brick") {
-          Vec2 positionEntityNode = entityNode->getComponent<CTransform>().pos;
-          entityNode->destroy();
-          auto explodeNode = m_entityManager.addEntity("Explosion");
-          explodeNode->addComponent<CAnimation>(
-              m_game->assets().getAnimation("Explosion"), true);
-          explodeNode->addComponent<CTransform>(positionEntityNode);
-        }
+void Scene_Play::sTileContacts() {
+  // bullets end on the first tile they touch, breaking it if it can be;
+  // tiles hit from below break or get bumped. A tile hit twice in one tick
+  // is only broken once.
+  for (const Contact &contact : m_contacts) {
+    if (contact.kind == Contact::Player) {
+      continue;
+    }
+    if (contact.kind == Contact::Bullet) {
+      // a bullet's contacts are next to each other, the first one ends it
+      const std::shared_ptr<Entity> &bullet =
+          *m_bulletBoxes[contact.other].entity;
+      if (!bullet->isActive()) {
+        continue;
       }
+      bullet->destroy();
+    }
+    const std::shared_ptr<Entity> &tile = *m_tileBoxes[contact.tile].entity;
+    if (!tile->isActive()) {
+      continue;
+    }
+    if (contact.flags & TileProperties::Breakable) {
+      breakTile(tile);
+    } else if (contact.kind == Contact::Head &&
+               (contact.flags & TileProperties::Bumpable)) {
+      bumpTile(tile);
+    }
+  }
+}
+
+void Scene_Play::breakTile(std::shared_ptr<Entity> tile) {
+  Vec2 tilePosition = tile->getComponent<CTransform>().pos;
+  tile->destroy();
+  m_levelStreamer->destroyTile(tile->getComponent<CTileProperties>().record);
+  auto explodeNode = m_entityManager.addEntity("Explosion");
+  if (explodeNode) {
+    explodeNode->addComponent<CAnimation>(
+        m_game->assets().getAnimation(m_explosionAnimation), true);
+    explodeNode->addComponent<CTransform>(tilePosition);
+  }
+}
+
+void Scene_Play::bumpTile(std::shared_ptr<Entity> tile) {
+  // copy, the component is replaced below
+  const CTileProperties properties = tile->getComponent<CTileProperties>();
+  const Assets &assets = m_game->assets();
+
+  if (properties.bumped.isValid()) {
+    auto &animation = tile->addComponent<CAnimation>(
+        assets.getAnimation(properties.bumped), true);
+    if (AnimationClock::isShareable(animation.animation)) {
+      animation.sharedClip =
+          int(m_tileAnimations.registerClip(animation.animation));
+    }
+    tile->addComponent<CTileProperties>(
+        assets.getTileProperties(properties.bumped), properties.record);
+    m_levelStreamer->replaceTile(properties.record, properties.bumped);
+  }
+
+  if (properties.reward.isValid()) {
+    Vec2 rewardPosition = tile->getComponent<CTransform>().pos;
+    rewardPosition.y -= tile->getComponent<CAnimation>().animation.getSize().y;
+    auto rewardNode = m_entityManager.addEntity("Coin");
+    if (rewardNode) {
+      rewardNode->addComponent<CAnimation>(
+          assets.getAnimation(properties.reward), true);
+      rewardNode->addComponent<CTransform>(rewardPosition);
     }
   }
-  //
-  // Bullet collision END
-  //
 }
 
 void Scene_Play::sDoAction(const Action &action) {
-  if (action.type() == "START") {
-    if (action.name() == "TOGGLE_TEXTURE") {
+  auto &input = m_player->getComponent<CInput>();
+
+  if (action.type() == ActionType::Start) {
+    switch (action.name()) {
+    case ActionName::ToggleTexture:
       m_drawTextures = !m_drawTextures;
-    } else if (action.name() == "TOGGLE_COLLISION") {
+      break;
+    case ActionName::ToggleCollision:
       m_drawCollision = !m_drawCollision;
-    } else if (action.name() == "TOGGLE_GRID") {
+      break;
+    case ActionName::ToggleGrid:
       m_drawGrid = !m_drawGrid;
-    } else if (action.name() == "PAUSE") {
+      break;
+    case ActionName::Pause:
       setPaused(!m_paused);
-    } else if (action.name() == "QUIT") {
+      break;
+    case ActionName::Quit:
       onEnd();
-    } else if (action.name() == "JUMP") {
+      break;
+    case ActionName::Jump:
       m_jumpActive = true;
-      m_player->getComponent<CInput>().up = true;
-    } else if (action.name() == "LEFT") {
-      m_player->getComponent<CInput>().left = true;
-    } else if (action.name() == "RIGHT") {
-      m_player->getComponent<CInput>().right = true;
-    } else if (action.name() == "DOWN") {
-      m_player->getComponent<CInput>().down = true;
-    } else if (action.name() == "SHOOT") {
-      if (m_player->getComponent<CInput>().canShoot) {
+      input.up = true;
+      break;
+    case ActionName::Left:
+      input.left = true;
+      break;
+    case ActionName::Right:
+      input.right = true;
+      break;
+    case ActionName::Down:
+      input.down = true;
+      break;
+    case ActionName::Shoot:
+      if (input.canShoot) {
         spawnBullet(m_player);
       }
-      m_player->getComponent<CInput>().canShoot = false;
+      input.canShoot = false;
+      break;
+    default:
+      break;
     }
-  } else if (action.type() == "END") {
-    if (action.name() == "JUMP") {
+  } else {
+    switch (action.name()) {
+    case ActionName::Jump:
       m_jumpActive = false;
-      m_player->getComponent<CInput>().up = false;
-    } else if (action.name() == "LEFT") {
-      m_player->getComponent<CInput>().left = false;
-    } else if (action.name() == "RIGHT") {
-      m_player->getComponent<CInput>().right = false;
-    } else if (action.name() == "DOWN") {
-      m_player->getComponent<CInput>().down = false;
-    } else if (action.name() == "SHOOT") {
-      m_player->getComponent<CInput>().canShoot = true;
+      input.up = false;
+      break;
+    case ActionName::Left:
+      input.left = false;
+      break;
+    case ActionName::Right:
+      input.right = false;
+      break;
+    case ActionName::Down:
+      input.down = false;
+      break;
+    case ActionName::Shoot:
+      input.canShoot = true;
+      break;
+    default:
+      break;
     }
   }
 }
 
 void Scene_Play::sAnimation() {
-  m_player->getComponent<CAnimation>().animation.update(m_animationIsFlipped);
-  for (auto &entityNode : m_entityManager.getEntities("Tile")) {
-    entityNode->getComponent<CAnimation>().animation.update(false);
-  }
+  auto &playerState = m_player->getComponent<CState>();
+  m_playerAnimations.update(playerState, m_player->getComponent<CAnimation>(),
+                            playerState.test(CState::FacingLeft));
+  // looping tile animations advance once per clip, not once per tile
+  m_tileAnimations.update(m_currentFrame);
   for (auto &entityNode : m_entityManager.getEntities("Explosion")) {
     auto &animation = entityNode->getComponent<CAnimation>().animation;
     animation.update(false);
@@ -475,8 +790,32 @@ void Scene_Play::sAnimation() {
 }
 
 void Scene_Play::onEnd() {
-  // When the scene ends, change back to the MENU scene
-  m_game->changeScene("MENU", std::make_shared<Scene_Menu>(m_game));
+  // When the scene ends, go back to the MENU scene below it; this one is
+  // cached and reset if the level is picked again
+  m_game->popScene();
+}
+
+bool Scene_Play::isReusable() const { return true; }
+
+uint32_t Scene_Play::checksum() {
+  // the jump is tracked by the scene and not on the player entity
+  const float jump[] = {float(m_jumpActive), float(m_isJumping), m_jumpTime};
+  return mixChecksum(Scene::checksum(), jump, sizeof(jump));
+}
+
+void Scene_Play::reset() {
+  // played again from the start, with the level and its assets still loaded
+  resetEntities();
+  m_tileAnimations = AnimationClock();
+  m_levelStreamer->reset();
+  m_currentFrame = 0;
+  m_paused = false;
+  m_hasEnded = false;
+  m_jumpActive = false;
+  m_isJumping = false;
+  m_jumpTime = 0.0f;
+  spawnPlayer();
+  sStreaming();
 }
 
 void Scene_Play::sRender() {
@@ -489,8 +828,7 @@ void Scene_Play::sRender() {
 
   // set the viewport of the window to be centered on the player if it's far
   // enough right
-  auto &pPos = m_player->getComponent<CTransform>().pos;
-  float windowCenterX = std::max(m_game->window().getSize().x / 2.0f, pPos.x);
+  float windowCenterX = viewCenterX();
   sf::View view = m_game->window().getView();
   view.setCenter(windowCenterX,
                  m_game->window().getSize().y - view.getCenter().y);
@@ -501,52 +839,83 @@ void Scene_Play::sRender() {
     for (const auto &e : m_entityManager.getEntities()) {
       auto &transform = e->getComponent<CTransform>();
       if (e->hasComponent<CAnimation>()) {
-        auto &animation = e->getComponent<CAnimation>().animation;
-        animation.getSprite().setRotation(transform.angle);
-        animation.getSprite().setPosition(transform.pos.x, transform.pos.y);
-        animation.getSprite().setScale(transform.scale.x, transform.scale.y);
-        m_game->window().draw(animation.getSprite());
+        auto &animation = e->getComponent<CAnimation>();
+        // entities on a shared clip are drawn with the clip's sprite
+        sf::Sprite &sprite =
+            animation.sharedClip >= 0
+                ? m_tileAnimations.sprite(animation.sharedClip)
+                : animation.animation.getSprite();
+        sprite.setRotation(transform.angle);
+        sprite.setPosition(transform.pos.x, transform.pos.y);
+        sprite.setScale(transform.scale.x, transform.scale.y);
+        m_game->window().draw(sprite);
       }
     }
   }
 
-  // draw all Entity collision bounding boxes with a rectangle shape
+  // the debug lines of the frame are staged in the frame arena and drawn
+  // with one call
+  FrameVector<sf::Vertex> lines{
+      FrameAllocator<sf::Vertex>(m_game->frameArena())};
+  auto addLine = [&lines](float x1, float y1, float x2, float y2) {
+    lines.emplace_back(sf::Vector2f(x1, y1));
+    lines.emplace_back(sf::Vector2f(x2, y2));
+  };
+
+  // draw all Entity collision bounding boxes as outlines
   if (m_drawCollision) {
     for (const auto &e : m_entityManager.getEntities()) {
       if (e->hasComponent<CBoundingBox>()) {
         auto &box = e->getComponent<CBoundingBox>();
         auto &transform = e->getComponent<CTransform>();
-        sf::RectangleShape rect;
-        rect.setSize(sf::Vector2f(box.size.x - 1, box.size.y - 1));
-        rect.setOrigin(sf::Vector2f(box.halfSize.x, box.halfSize.y));
-        rect.setPosition(transform.pos.x, transform.pos.y);
-        rect.setFillColor(sf::Color(0, 0, 0, 0));
-        rect.setOutlineColor(sf::Color::White);
-        rect.setOutlineThickness(1);
-        m_game->window().draw(rect);
+        const float left = transform.pos.x - box.halfSize.x;
+        const float top = transform.pos.y - box.halfSize.y;
+        const float right = left + box.size.x - 1;
+        const float bottom = top + box.size.y - 1;
+        addLine(left, top, right, top);
+        addLine(right, top, right, bottom);
+        addLine(right, bottom, left, bottom);
+        addLine(left, bottom, left, top);
       }
     }
   }
 
   // draw the grid so that can easily debug
+  float leftX = m_game->window().getView().getCenter().x - width() / 2.0;
+  float rightX = leftX + width() + m_gridSize.x;
+  float nextGridX = leftX - ((int)leftX % (int)m_gridSize.x);
   if (m_drawGrid) {
-    float leftX = m_game->window().getView().getCenter().x - width() / 2.0;
-    float rightX = leftX + width() + m_gridSize.x;
-    float nextGridX = leftX - ((int)leftX % (int)m_gridSize.x);
-
     for (float x = nextGridX; x < rightX; x += m_gridSize.x) {
-      drawLine(Vec2(x, 0), Vec2(x, height()));
+      addLine(x, 0, x, height());
     }
-
     for (float y = 0; y < height(); y += m_gridSize.y) {
-      drawLine(Vec2(leftX, height() - y), Vec2(rightX, height() - y));
+      addLine(leftX, height() - y, rightX, height() - y);
+    }
+  }
+
+  if (!lines.empty()) {
+    m_game->window().draw(lines.data(), lines.size(), sf::Lines);
+  }
 
+  // the labels go on top of the lines
+  if (m_drawGrid) {
+    const int columns = int(width() / m_gridSize.x) + 2;
+    const int rows = int(height() / m_gridSize.y) + 1;
+    if (m_gridLabels.size() != size_t(columns * rows)) {
+      m_gridLabels.assign(size_t(columns * rows), GridLabel{-1, m_gridText});
+    }
+    for (float y = 0; y < height(); y += m_gridSize.y) {
       for (float x = nextGridX; x < rightX; x += m_gridSize.x) {
-        std::string xCell = std::to_string((int)x / (int)m_gridSize.x);
-        std::string yCell = std::to_string((int)y / (int)m_gridSize.y);
-        m_gridText.setString("(" + xCell + "," + yCell + ")");
-        m_gridText.setPosition(x + 3, height() - y - m_gridSize.y + 2);
-        m_game->window().draw(m_gridText);
+        const int column = (int)x / (int)m_gridSize.x;
+        const int row = (int)y / (int)m_gridSize.y;
+        GridLabel &label = m_gridLabels[(column % columns) * rows + row];
+        if (label.column != column) {
+          label.column = column;
+          label.text.setString("(" + std::to_string(column) + "," +
+                               std::to_string(row) + ")");
+        }
+        label.text.setPosition(x + 3, height() - y - m_gridSize.y + 2);
+        m_game->window().draw(label.text);
       }
     }
   }
@@ -0,0 +1,44 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  if (threadCount == 0) {
+    const size_t hardwareThreads = std::thread::hardware_concurrency();
+    threadCount = std::max<size_t>(2, hardwareThreads) - 1;
+  }
+
+  m_workers.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; i++) {
+    m_workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wakeUp.notify_all();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeUp.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+      // pending jobs are still run on shutdown so no future is left broken
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    job();
+  }
+}
+
+size_t ThreadPool::size() const { return m_workers.size(); }
@@ -0,0 +1,23 @@
+#include "../include/TileProperties.h"
+#include "../include/AssetManifest.h"
+#include <sstream>
+
+uint32_t TileProperties::parseFlags(const std::string &list) {
+  uint32_t flags = 0;
+  std::stringstream stream(list);
+  std::string flag;
+  while (std::getline(stream, flag, ',')) {
+    if (flag == "solid") {
+      flags |= Solid;
+    } else if (flag == "breakable") {
+      flags |= Breakable;
+    } else if (flag == "bumpable") {
+      flags |= Bumpable;
+    } else if (flag == "goal") {
+      flags |= Goal;
+    } else if (flag != "-") {
+      throw AssetError("Unknown tile flag: " + flag);
+    }
+  }
+  return flags;
+}
@@ -1,9 +1,63 @@
 #include "../include/GameEngine.h"
+#include "../include/Level.h"
 #include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iostream>
 
-int main() {
-  GameEngine g("../bin/assets.txt");
-  g.run();
+int usage(const char *program) {
+  std::cerr << "usage: " << program
+            << " [--record file] [--replay file] [--alloc-test] [--headless]"
+               " [--vsync] [--capture n] [--asset-budget mb]\n";
+  return 2;
+}
+
+int main(int argc, char *argv[]) {
+  GameOptions options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--headless") {
+      options.headless = true;
+    } else if (arg == "--capture" && i + 1 < argc) {
+      options.captureInterval = std::strtoul(argv[++i], nullptr, 10);
+      if (options.captureInterval == 0) {
+        return usage(argv[0]);
+      }
+    } else if (arg == "--asset-budget" && i + 1 < argc) {
+      options.assetMemoryBudget =
+          size_t(std::strtoul(argv[++i], nullptr, 10)) << 20;
+    } else if (arg == "--vsync") {
+      options.vsync = true;
+    } else if (arg == "--alloc-test") {
+      options.allocationTest = true;
+    } else if (arg == "--record" && i + 1 < argc) {
+      options.record = argv[++i];
+    } else if (arg == "--replay" && i + 1 < argc) {
+      options.replay = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  // nothing could end a headless run but a recording or the test
+  if (options.headless && options.replay.empty() && !options.allocationTest) {
+    return usage(argv[0]);
+  }
+
+  try {
+    GameEngine g("../bin/assets.txt", options);
+    g.run();
+    if (g.failed()) {
+      return 1;
+    }
+  } catch (const AssetError &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (const LevelError &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (const ReplayError &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
 
   return 0;
 }
@@ -0,0 +1,87 @@
+// Packs an assets file and every image and font it references into a single
+// bundle that Assets::loadFromBundle maps without decoding anything.
+//
+// usage: megaMario_bundler <assets.txt> <assets.bundle>
+// paths inside the assets file are relative to the working directory
+
+#include <SFML/Graphics/Image.hpp>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+
+#include "../include/AssetBundle.h"
+#include "../include/AssetManifest.h"
+#include "../include/TileProperties.h"
+
+namespace {
+uint32_t lookup(const std::map<std::string, uint32_t> &indices,
+                const std::string &name, const std::string &kind) {
+  auto it = indices.find(name);
+  if (it == indices.end()) {
+    throw AssetError("Unknown " + kind + ": " + name);
+  }
+  return it->second;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <assets.txt> <assets.bundle>\n";
+    return 2;
+  }
+
+  try {
+    AssetManifest manifest;
+    manifest.loadFromFile(argv[1]);
+    AssetBundleWriter writer;
+
+    std::map<std::string, uint32_t> textures;
+    for (const auto &entry : manifest.textures) {
+      sf::Image image;
+      if (!image.loadFromFile(entry.path)) {
+        throw AssetError("Could not load image: " + entry.path + "!");
+      }
+      textures[entry.name] =
+          writer.addTexture(entry.name, image.getSize().x, image.getSize().y,
+                            image.getPixelsPtr());
+    }
+
+    std::map<std::string, uint32_t> animations;
+    for (const auto &entry : manifest.animations) {
+      animations[entry.name] = writer.addAnimation(
+          entry.name, lookup(textures, entry.texture, "texture"),
+          uint32_t(entry.frameCount), uint32_t(entry.speed));
+    }
+
+    for (const auto &entry : manifest.fonts) {
+      std::ifstream file(entry.path, std::ios::binary);
+      if (!file) {
+        throw AssetError("Could not load font: " + entry.path);
+      }
+      writer.addFont(entry.name,
+                     std::vector<char>(std::istreambuf_iterator<char>(file),
+                                       std::istreambuf_iterator<char>()));
+    }
+
+    for (const auto &entry : manifest.tileTypes) {
+      auto optional = [&animations](const std::string &name) {
+        return name == "-" ? AssetBundle::kNone
+                           : lookup(animations, name, "animation");
+      };
+      writer.addTileType(lookup(animations, entry.animation, "animation"),
+                         TileProperties::parseFlags(entry.flags),
+                         optional(entry.reward), optional(entry.bumped));
+    }
+
+    writer.writeToFile(argv[2]);
+    std::cout << "Wrote " << argv[2] << ": " << manifest.textures.size()
+              << " textures, " << manifest.animations.size()
+              << " animations, " << manifest.fonts.size() << " fonts\n";
+  } catch (const AssetError &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,29 @@
+// Compiles a text level into the binary format that Scene_Play::loadLevel
+// maps directly: an interned animation name table followed by packed
+// (type, asset, gridX, gridY) records.
+//
+// usage: megaMario_levelc <levelN.txt> <levelN.lvl>
+
+#include <iostream>
+
+#include "../include/Level.h"
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <level.txt> <level.lvl>\n";
+    return 2;
+  }
+
+  try {
+    LevelData level;
+    level.loadFromText(argv[1]);
+    level.writeBinary(argv[2]);
+    std::cout << "Wrote " << argv[2] << ": " << level.entities.size()
+              << " entities, " << level.assets.size() << " animations\n";
+  } catch (const LevelError &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Writes a synthetic level for load, frame time and memory testing. The
+// output is a text level, or a compiled one when the name ends in ".lvl".
+//
+// usage: megaMario_levelgen [--seed n] [--length columns] [--tiles n]
+//                           [--density p] [--breakable p]
+//                           [--decorations p] <level.txt|level.lvl>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../include/LevelGenerator.h"
+
+static int usage(const char *program) {
+  std::cerr << "usage: " << program
+            << " [--seed n] [--length columns] [--tiles n] [--density p]"
+               " [--breakable p] [--decorations p] <level.txt|level.lvl>\n";
+  return 2;
+}
+
+int main(int argc, char *argv[]) {
+  LevelGeneratorConfig config;
+  std::string output;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--", 0) != 0) {
+      if (!output.empty()) {
+        return usage(argv[0]);
+      }
+      output = arg;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      return usage(argv[0]);
+    }
+    const char *value = argv[++i];
+    if (arg == "--seed") {
+      config.seed = uint32_t(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--length") {
+      config.length = uint32_t(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--tiles") {
+      config.tiles = uint32_t(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--density") {
+      config.density = std::strtof(value, nullptr);
+    } else if (arg == "--breakable") {
+      config.breakable = std::strtof(value, nullptr);
+    } else if (arg == "--decorations") {
+      config.decorations = std::strtof(value, nullptr);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (output.empty()) {
+    return usage(argv[0]);
+  }
+
+  try {
+    const LevelData level = generateLevel(config);
+    const bool compiled =
+        output.size() > 4 && output.compare(output.size() - 4, 4, ".lvl") == 0;
+    if (compiled) {
+      level.writeBinary(output);
+    } else {
+      level.writeText(output);
+    }
+    std::cout << "Wrote " << output << ": " << level.entities.size()
+              << " entities in " << level.chunks.size() << " chunks\n";
+  } catch (const LevelError &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}